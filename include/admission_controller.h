@@ -0,0 +1,59 @@
+#ifndef ADMISSION_CONTROLLER_H
+#define ADMISSION_CONTROLLER_H
+
+#include "server.h"
+#include "rate_limiter.h"
+
+#include <atomic>
+#include <cstddef>
+
+// 准入控制
+// 按请求类型统计正在进行的上传/下载数，超过MAX_CONCURRENT_UPLOADS/DOWNLOADS的请求
+// 在头部到齐时即被拒绝（503 + Retry-After），不再读取body，避免大上传突发时内存失控。
+// 名额在响应发送完或连接回收时归还。所有事件循环共享同一实例，计数使用原子操作。
+// 同时持有按客户端IP的限流器：请求速率在准入时检查（超限回复429），字节速率在每次发送时检查。
+class AdmissionController {
+public:
+    // 统计快照
+    struct Metrics {
+        size_t uploads_in_flight;
+        size_t downloads_in_flight;
+        size_t max_uploads;
+        size_t max_downloads;
+        size_t rejected_uploads;
+        size_t rejected_downloads;
+        size_t rejected_connections;  // 超过最大连接数被拒绝的连接
+    };
+
+    AdmissionController(size_t max_uploads, size_t max_downloads);
+
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    // 申请名额；不受限的请求类型总是成功
+    bool try_acquire(TaskType type);
+    void release(TaskType type);
+
+    // 超过最大连接数时直接回复503并关闭socket（非阻塞发送，尽力而为）
+    void reject_connection(socket_t socket);
+
+    RateLimiter& rate_limiter() { return rate_limiter_; }
+
+    Metrics get_metrics() const;
+
+private:
+    struct Limit {
+        std::atomic<size_t> in_flight{0};
+        std::atomic<size_t> rejected{0};
+        size_t max = 0;
+    };
+
+    Limit* limit_for(TaskType type);
+
+    Limit uploads_;
+    Limit downloads_;
+    std::atomic<size_t> rejected_connections_;
+    RateLimiter rate_limiter_;
+};
+
+#endif // ADMISSION_CONTROLLER_H
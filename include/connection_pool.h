@@ -0,0 +1,43 @@
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include "server.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 连接对象池
+// 连接的最后一个引用释放时对象不析构，而是连同读写缓冲区已分配的容量一起回到池中，
+// 下一次accept直接复用，避免每个连接都重新分配Connection和64KB读取缓冲区。
+// 每个事件循环一个池；最后一个引用可能在工作线程中释放，因此归还路径加锁。
+// 必须通过std::make_shared创建，借出的连接持有池的引用，池会活到最后一个连接归还。
+class ConnectionPool : public std::enable_shared_from_this<ConnectionPool> {
+public:
+    explicit ConnectionPool(size_t max_idle);
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // 取出空闲连接（池为空时新建）并绑定到新socket
+    std::shared_ptr<Connection> acquire(socket_t socket, const std::string& client_ip);
+
+    size_t idle_count() const;
+    size_t created_count() const { return created_.load(std::memory_order_relaxed); }
+    size_t reused_count() const { return reused_.load(std::memory_order_relaxed); }
+
+private:
+    void release(Connection* conn);
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Connection>> idle_;
+    size_t max_idle_;
+
+    std::atomic<size_t> created_;
+    std::atomic<size_t> reused_;
+};
+
+#endif // CONNECTION_POOL_H
@@ -0,0 +1,57 @@
+#ifndef CONNECTION_TABLE_H
+#define CONNECTION_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Connection;
+
+// 连接句柄：低32位为槽位下标（由fd得到），高32位为槽位代数
+// fd关闭并被新连接复用后代数递增，旧句柄查找时返回nullptr
+using ConnectionHandle = uint64_t;
+constexpr ConnectionHandle INVALID_CONNECTION_HANDLE = ~ConnectionHandle(0);
+
+// 以fd为下标的slab连接表
+// 增加、查找、删除都是O(1)，槽位数组只随最大fd增长，不做整体搬移或线性查找。
+// 不加锁，由所属线程（事件循环）独占使用。
+class ConnectionTable {
+public:
+    ConnectionTable();
+
+    // fd在Windows下为SOCKET句柄
+    // 插入连接并返回句柄；fd对应槽位已被占用时返回INVALID_CONNECTION_HANDLE
+    ConnectionHandle insert(uintptr_t fd, std::shared_ptr<Connection> conn);
+
+    // 句柄过期（连接已删除或fd已被复用）时返回nullptr
+    std::shared_ptr<Connection> get(ConnectionHandle handle) const;
+    // 返回当前占用fd对应槽位的连接
+    std::shared_ptr<Connection> find(uintptr_t fd) const;
+
+    bool erase(ConnectionHandle handle);
+    void clear();
+
+    size_t size() const { return size_; }
+
+    template <typename Func>
+    void for_each(Func&& func) const {
+        for (const Slot& slot : slots_) {
+            if (slot.conn) func(slot.conn);
+        }
+    }
+
+private:
+    struct Slot {
+        std::shared_ptr<Connection> conn;
+        uint32_t generation = 0;
+    };
+
+    static size_t index_of(uintptr_t fd);
+    const Slot* lookup(ConnectionHandle handle) const;
+
+    std::vector<Slot> slots_;
+    size_t size_;
+};
+
+#endif // CONNECTION_TABLE_H
@@ -0,0 +1,141 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include "server.h"
+#include "timer_wheel.h"
+#include "connection_table.h"
+#include "connection_pool.h"
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <chrono>
+
+#ifndef _WIN32
+
+// 事件循环（反应器）基类
+// 每个事件循环独占一个监听socket以及在其上接受的全部连接，
+// 连接的读写、关闭和超时清理都只在事件循环线程中进行，因此无需加锁。
+// 具体的I/O机制（epoll / io_uring）由子类实现。
+class EventLoop {
+public:
+    // 请求就绪时的处理函数，返回false表示不接管、由事件循环线程内联处理；未设置时同样内联处理
+    using RequestHandler = std::function<bool(EventLoop&, std::shared_ptr<Connection>)>;
+    // 把连接的磁盘任务投递到磁盘通道，队列已满时返回false
+    using DiskHandler = std::function<bool(std::shared_ptr<Connection>, std::function<void()>)>;
+
+    // listen_socket的所有权转移给事件循环，销毁时由事件循环关闭
+    EventLoop(size_t id, socket_t listen_socket, size_t max_connections);
+    virtual ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    void set_request_handler(RequestHandler handler) { request_handler_ = std::move(handler); }
+    // 新连接使用的准入控制器，需在start之前设置
+    void set_admission_controller(AdmissionController* admission) { admission_ = admission; }
+    // 上传body的写入交给磁盘通道，需在start之前设置；未设置时由连接在事件循环线程直接写入
+    void set_disk_handler(DiskHandler handler) { disk_handler_ = std::move(handler); }
+
+    // cpu >= 0 时把事件循环线程绑定到指定CPU核心
+    bool start(int cpu = -1);
+    void stop();
+
+    // 线程安全：把回调投递到事件循环线程执行
+    void post(std::function<void()> functor);
+
+    // 线程安全：工作线程处理完请求后，由事件循环线程写回响应
+    void complete_request(std::shared_ptr<Connection> conn, ResponseBuffer response_data);
+
+    size_t id() const { return id_; }
+    size_t get_active_connections() const { return active_connections_; }
+    size_t get_total_requests() const { return total_requests_; }
+
+protected:
+    virtual bool setup() = 0;
+    virtual void run() = 0;
+    virtual void wakeup() = 0;
+    virtual void send_response(const std::shared_ptr<Connection>& conn, ResponseBuffer response_data) = 0;
+    virtual void close_all_connections() = 0;
+    // 限速结束后继续发送该连接剩余的响应数据
+    virtual void resume_write(const std::shared_ptr<Connection>& conn) = 0;
+    // 磁盘写入完成后恢复读取因此暂停的连接
+    virtual void resume_read(const std::shared_ptr<Connection>& conn) = 0;
+
+    // 新连接的公共初始化：超过连接上限时关闭socket并返回nullptr
+    std::shared_ptr<Connection> create_connection(socket_t client_socket,
+                                                  const struct sockaddr_in* peer_addr = nullptr);
+    void handle_request(std::shared_ptr<Connection> conn);
+    // 在磁盘通道执行连接的body写入任务，完成后回到事件循环线程通知连接并恢复读取
+    bool run_body_task(std::shared_ptr<Connection> conn, std::function<void()> work);
+    void run_pending_functors();
+    // 发送因限速暂停的连接登记到延迟队列，由子类在每个tick调用resume_deferred_writes重试
+    void defer_write(const std::shared_ptr<Connection>& conn);
+    void resume_deferred_writes();
+
+    size_t id_;
+    socket_t listen_socket_;
+    size_t max_connections_;
+    std::atomic<bool> running_;
+    std::thread thread_;
+
+    std::mutex pending_mutex_;
+    std::vector<std::function<void()>> pending_functors_;
+
+    RequestHandler request_handler_;
+    DiskHandler disk_handler_;
+    AdmissionController* admission_ = nullptr;
+    
+    // 连接超时时间轮，create_connection时挂入，由子类在定时tick中推进
+    TimerWheel timer_wheel_;
+
+    // 因发送限速暂停的连接
+    std::vector<std::weak_ptr<Connection>> deferred_writes_;
+
+    // 连接对象池，create_connection从中取出连接，连接释放后自动归还
+    std::shared_ptr<ConnectionPool> connection_pool_;
+
+    // 统计信息（每个事件循环独立计数，避免多核争用同一缓存行）
+    std::atomic<size_t> active_connections_;
+    std::atomic<size_t> total_requests_;
+};
+
+// 基于边缘触发epoll的事件循环
+class EpollEventLoop : public EventLoop {
+public:
+    EpollEventLoop(size_t id, socket_t listen_socket, size_t max_connections);
+    ~EpollEventLoop() override;
+
+protected:
+    bool setup() override;
+    void run() override;
+    void wakeup() override;
+    void send_response(const std::shared_ptr<Connection>& conn, ResponseBuffer response_data) override;
+    void close_all_connections() override;
+    void resume_write(const std::shared_ptr<Connection>& conn) override;
+    void resume_read(const std::shared_ptr<Connection>& conn) override;
+
+private:
+    void accept_connections();
+    void handle_connection_event(ConnectionHandle handle, uint32_t events);
+    void resume_reading(const std::shared_ptr<Connection>& conn);
+    void close_if_finished(const std::shared_ptr<Connection>& conn);
+    void close_connection(const std::shared_ptr<Connection>& conn);
+    void cleanup_expired_connections();
+
+    epoll_handle_t epoll_handle_;
+    std::vector<struct epoll_event> epoll_events_;
+    int wakeup_fd_;
+
+    // 本事件循环拥有的连接，只在事件循环线程中访问；epoll事件携带连接句柄
+    ConnectionTable connections_;
+    std::chrono::steady_clock::time_point last_cleanup_;
+};
+
+#endif // !_WIN32
+
+#endif // EVENT_LOOP_H
@@ -5,6 +5,8 @@
 #include <vector>
 #include <fstream>
 #include <filesystem>
+#include <memory>
+#include <cstdint>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -18,6 +20,63 @@ struct FileInfo {
     std::string mime_type;
 };
 
+// 为发送而打开的文件：作为响应体时由连接直接从文件发送（Linux下sendfile），不读入内存
+// 由响应和输出缓冲区共享，最后一个持有者析构时关闭文件
+class FileBody {
+public:
+    FileBody(int fd, uint64_t size, int64_t modified_time, uint32_t modified_nsec, uint64_t inode);
+    ~FileBody();
+    
+    FileBody(const FileBody&) = delete;
+    FileBody& operator=(const FileBody&) = delete;
+    
+    int fd() const { return fd_; }
+    uint64_t size() const { return size_; }
+    // 打开时的修改时间（Unix时间戳，秒）及其纳秒部分（平台不提供时为0）
+    int64_t modified_time() const { return modified_time_; }
+    uint32_t modified_nsec() const { return modified_nsec_; }
+    // 文件系统中的文件编号（inode），平台不提供时为0
+    uint64_t inode() const { return inode_; }
+    
+    // 从position处读取最多length字节，返回读取的字节数，出错返回-1（无sendfile的平台分块发送时使用）
+    long long read(uint64_t position, char* buffer, size_t length) const;
+    
+private:
+    int fd_;
+    uint64_t size_;
+    int64_t modified_time_;
+    uint32_t modified_nsec_;
+    uint64_t inode_;
+};
+
+// 流式写入的上传文件：数据先写入上传目录中的隐藏临时文件，commit时改名为目标文件，
+// 未提交就析构（上传中断或出错）时删除临时文件，不会留下不完整的文件
+class FileWriter {
+public:
+    FileWriter(int fd, std::filesystem::path temp_path, std::filesystem::path final_path);
+    ~FileWriter();
+    
+    FileWriter(const FileWriter&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+    
+    int fd() const { return fd_; }
+    uint64_t size() const { return size_; }
+    
+    // 写入全部数据，失败返回false
+    bool write(const char* data, size_t length);
+    // 由调用方直接写入fd（例如splice）后登记写入的字节数
+    void add_written(uint64_t length) { size_ += length; }
+    // 关闭文件并改名为目标文件名
+    bool commit();
+    
+private:
+    int fd_;
+    uint64_t size_;
+    bool committed_;
+    std::filesystem::path temp_path_;
+    std::filesystem::path final_path_;
+};
+
 class FileManager {
 public:
     FileManager(const std::string& upload_dir = "uploads");
@@ -28,6 +87,10 @@ public:
     bool save_file(const std::string& filename, const char* data, size_t size);
     
     std::vector<char> read_file(const std::string& filename);
+    // 打开文件用于发送，不读取内容；失败时返回nullptr
+    std::shared_ptr<FileBody> open_file(const std::string& filename);
+    // 创建用于流式写入的文件；失败时返回nullptr
+    std::unique_ptr<FileWriter> create_file(const std::string& filename);
     
     // 修改为支持宽字符的文件操作函数
     bool file_exists(const std::string& filename);
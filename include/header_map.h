@@ -0,0 +1,81 @@
+#ifndef HEADER_MAP_H
+#define HEADER_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 常用头部的编号，查找时不必比较名称
+enum class HeaderId : uint8_t {
+    CONTENT_LENGTH,
+    CONTENT_TYPE,
+    CONTENT_RANGE,
+    CONTENT_DISPOSITION,
+    CONNECTION,
+    KEEP_ALIVE,
+    HOST,
+    EXPECT,
+    RANGE,
+    IF_RANGE,
+    IF_NONE_MATCH,
+    IF_MODIFIED_SINCE,
+    ETAG,
+    LAST_MODIFIED,
+    ACCEPT_RANGES,
+    RETRY_AFTER,
+    TRANSFER_ENCODING,
+    OTHER  // 不在上面的头部，按名称查找
+};
+
+// HTTP头部集合
+// 头部按加入顺序存放在一个vector中（一次分配，不像std::map每个头部一个节点），名称比较不区分大小写。
+// 常用头部在加入时识别出编号，另有按编号索引的位置表，按编号查找是O(1)；
+// 其他头部按名称线性查找，请求和响应的头部通常只有十几个。
+class HeaderMap {
+public:
+    struct Header {
+        HeaderId id;
+        std::string name;
+        std::string value;
+    };
+
+    using const_iterator = std::vector<Header>::const_iterator;
+
+    HeaderMap();
+
+    // 名称对应的常用头部编号，不是常用头部时返回OTHER
+    static HeaderId lookup(std::string_view name);
+    static bool equals_ignore_case(std::string_view a, std::string_view b);
+
+    // 取值，没有该头部时返回nullptr
+    const std::string* get(HeaderId id) const;
+    const std::string* get(std::string_view name) const;
+    bool contains(HeaderId id) const { return get(id) != nullptr; }
+    bool contains(std::string_view name) const { return get(name) != nullptr; }
+
+    // 设置头部，已有同名头部时覆盖其值（保留原来的名称写法和位置）
+    void set(std::string_view name, std::string value);
+    // 加入头部，已有同名头部时保留原值并返回false；请求头部用它加入，与RequestParser::find_header一样以第一个为准
+    bool insert(std::string_view name, std::string value);
+    // 取值的引用，没有时先加入一个空值，用法同std::map
+    std::string& operator[](std::string_view name);
+
+    void clear();
+    size_t size() const { return headers_.size(); }
+    bool empty() const { return headers_.empty(); }
+    const_iterator begin() const { return headers_.begin(); }
+    const_iterator end() const { return headers_.end(); }
+
+private:
+    static constexpr size_t KNOWN_COUNT = static_cast<size_t>(HeaderId::OTHER);
+    static constexpr uint16_t NOT_PRESENT = UINT16_MAX;
+
+    Header* find(HeaderId id, std::string_view name);
+
+    std::vector<Header> headers_;
+    uint16_t positions_[KNOWN_COUNT];  // 常用头部在headers_中的位置
+};
+
+#endif // HEADER_MAP_H
@@ -2,32 +2,127 @@
 #define HTTP_HANDLER_H
 
 #include <string>
-#include <map>
 #include <vector>
+#include <memory>
+#include <cstdint>
+#include <string_view>
+
+#include "header_map.h"
+#include "response_writer.h"
+
+class FileBody;
+class RequestParser;
+
+// 服务器的全部端点，路由在http_handler.cpp的路由表中统一注册
+enum class Endpoint {
+    LIST_FILES,          // GET /files
+    DOWNLOAD_FILE,       // GET /download/{name}
+    STATS,               // GET /stats
+    UPLOAD,              // POST /upload
+    PUT_FILE,            // PUT /files/{name}
+    DELETE_FILE,         // DELETE /delete/{name}
+    NOT_FOUND,           // 方法受支持，但没有对应的路径
+    METHOD_NOT_ALLOWED   // 不支持的方法
+};
 
 struct HttpRequest {
     std::string method;
     std::string path;
     std::string version;
-    std::map<std::string, std::string> headers;
+    HeaderMap headers;
     std::string body;
+    // 路径中的{name}参数（未解码），由路由结果填入
+    std::string name;
+};
+
+// 文件响应体中的一段：先发送prefix（多段响应的分隔行和段头部），再从文件发送[offset, offset + length)
+struct FileRange {
+    std::string prefix;
+    uint64_t offset;
+    uint64_t length;
 };
 
 struct HttpResponse {
     int status_code;
     std::string status_text;
-    std::map<std::string, std::string> headers;
+    HeaderMap headers;
+    std::string body;
+    // 文件响应体：body之后依次发送各个文件区间，最后发送trailer（多段响应的结束分隔行），文件内容不读入内存
+    std::shared_ptr<FileBody> file;
+    std::vector<FileRange> file_ranges;
+    std::string trailer;
+    
+    // body、文件区间及其前缀和trailer的总长度，即Content-Length
+    uint64_t content_length() const;
+};
+
+// 序列化后的响应：状态行和头部单独保存，body原样移入，
+// 发送时分别作为两段iovec交给writev/sendmsg，不再把body拼接到头部后面；
+// 内容固定的小响应连同body一起写在head中
+struct ResponseBuffer {
+    ResponseHead head;
     std::string body;
+    // 文件响应体，由连接用sendfile直接发送
+    std::shared_ptr<FileBody> file;
+    std::vector<FileRange> file_ranges;
+    std::string trailer;
+    
+    uint64_t size() const;
+};
+
+// 流式接收的请求body：头部到齐后由连接创建，body数据到达时直接写入，不在内存中累积整个body
+class BodySink {
+public:
+    virtual ~BodySink() = default;
+    
+    // 写入一段body数据，返回false表示出错，之后的数据仍可写入但会被丢弃
+    virtual bool write(const char* data, size_t length) = 0;
+    // 不经过用户态直接从socket接收最多max_length字节body（Linux splice进管道），返回接收的字节数，对端关闭返回0；
+    // 出错返回-1并设置errno，不支持时errno为ENOSYS，调用方改用recv读取后调用write。
+    // 接收的数据暂存在内核中，由调用方在磁盘通道调用write_received写入，之后才能再次接收
+    virtual long long receive_from(int socket, uint64_t max_length);
+    // 把receive_from暂存的length字节写入，返回false表示出错
+    virtual bool write_received(uint64_t length);
+    // body全部到达后生成响应
+    virtual HttpResponse finish() = 0;
 };
 
 class HttpHandler {
 public:
     HttpHandler();
     
+    // 端点的处理函数，在路由表中与路径一起注册
+    using Handler = HttpResponse (HttpHandler::*)(const HttpRequest& request);
+    
+    // 路由结果：每个请求只查一次，由调用方保存
+    struct Route {
+        Endpoint endpoint;
+        Handler handler;   // STATS、NOT_FOUND、METHOD_NOT_ALLOWED时为nullptr，由调用方直接回复
+        std::string name;  // 路径中的{name}参数（未解码），复制出来，不依赖请求缓冲区
+    };
+    
+    // 按方法和路径查路由表
+    static Route route(std::string_view method, std::string_view path);
+    
     HttpRequest parse_request(const std::string& raw_request);
+    // 由已解析的头部构造请求，raw_request为解析时的缓冲区，头部之后的数据作为body
+    static HttpRequest make_request(const RequestParser& parser, std::string_view raw_request);
     std::string build_response(const HttpResponse& response);
+    // 头部与body分离的响应，body从response中移出，不做拷贝
+    ResponseBuffer build_response(HttpResponse&& response);
     
     HttpResponse handle_upload(const HttpRequest& request);
+    // PUT /files/{name}：body即文件内容；正常情况下由create_body_sink流式接收，
+    // 这里处理body已在内存中的请求，以及无法创建文件等错误
+    HttpResponse handle_put_file(const HttpRequest& request);
+    // 需要流式接收body的请求（multipart上传、PUT上传）返回对应的BodySink，其他请求返回nullptr；
+    // endpoint为该请求的路由结果
+    std::unique_ptr<BodySink> create_body_sink(Endpoint endpoint, const HttpRequest& request);
+    // multipart部分头部中的文件名（已转换为本地文件系统编码），没有文件名时返回空串
+    std::string part_filename(const std::string& part_headers);
+    // 上传结果：全部成功200，全部失败500，部分成功207
+    static HttpResponse build_upload_response(const std::vector<std::string>& saved_files,
+                                              const std::vector<std::string>& failed_files);
     HttpResponse handle_download(const HttpRequest& request);
     HttpResponse handle_list_files(const HttpRequest& request);
     HttpResponse handle_delete_file(const HttpRequest& request);
@@ -35,15 +130,28 @@ public:
     static std::string get_mime_type(const std::string& filename);
     static std::string url_encode(const std::string& str);
     static std::string url_decode(const std::string& encoded);
+    // RFC 7231 HTTP-date，例如"Sun, 06 Nov 1994 08:49:37 GMT"
+    static std::string format_http_date(int64_t unix_time);
+    // 解析IMF-fixdate格式的HTTP-date，不认识的格式返回false
+    static bool parse_http_date(const std::string& text, int64_t& unix_time);
     
 private:
-    std::vector<std::string> parse_headers(const std::string& header_text);
-    std::pair<std::string, std::string> parse_header_line(const std::string& line);
+    // PUT路径中{name}参数对应的文件名（已解码并转换为本地文件系统编码），无效时返回空串
+    std::string put_filename(std::string_view name);
+    // Content-Type中的multipart boundary，没有时返回空串
+    static std::string parse_boundary(const std::string& content_type);
+    // 条件请求：If-None-Match与etag匹配，或（没有If-None-Match时）文件在If-Modified-Since之后未修改，
+    // modified_time小于0表示没有修改时间
+    bool is_not_modified(const HttpRequest& request, const std::string& etag, int64_t modified_time);
+    // 按Range头选择要发送的文件区间：返回false表示忽略Range发送整个文件，
+    // ranges为空表示所有区间都无法满足（416）
+    bool parse_byte_ranges(const std::string& range_header, uint64_t file_size,
+                           std::vector<FileRange>& ranges);
 		std::string file_name_url_decode(const std::string& src);
 		std::string parse_filename(const std::string& part);
     std::wstring utf8_to_wstring(const std::string& str);
     //uft8 תGBK
-    std::string HttpHandler::utf8_to_acp(const std::string& utf8);
+    std::string utf8_to_acp(const std::string& utf8);
 };
 
 #endif // HTTP_HANDLER_H 
\ No newline at end of file
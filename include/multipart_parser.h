@@ -0,0 +1,61 @@
+#ifndef MULTIPART_PARSER_H
+#define MULTIPART_PARSER_H
+
+#include <cstddef>
+#include <string>
+
+// multipart/form-data增量解析器
+// 数据按到达顺序分段喂入，不要求整个body在内存中。分隔行"\r\n--boundary"用向量化查找（SimdScan），
+// 各部分的内容一经确认不属于分隔行就交给回调，解析器只保留不足一个分隔行长度的尾部，
+// 以及单个部分的头部（上限MAX_PART_HEADER_SIZE），内存占用与body大小无关。
+class MultipartParser {
+public:
+    // 部分的头部超过此长度视为格式错误
+    static constexpr size_t MAX_PART_HEADER_SIZE = 16 * 1024;
+
+    class Handler {
+    public:
+        virtual ~Handler() = default;
+        // 一个部分的头部（不含结尾空行）
+        virtual void on_part_begin(const std::string& headers) = 0;
+        // 部分内容，可能分多次回调
+        virtual void on_part_data(const char* data, size_t length) = 0;
+        // 部分内容结束（已遇到下一个分隔行）
+        virtual void on_part_end() = 0;
+    };
+
+    MultipartParser(const std::string& boundary, Handler& handler);
+
+    MultipartParser(const MultipartParser&) = delete;
+    MultipartParser& operator=(const MultipartParser&) = delete;
+
+    // 喂入一段body数据，格式错误时返回false，之后的数据全部忽略
+    bool feed(const char* data, size_t length);
+
+    // 已遇到结束分隔行"--boundary--"
+    bool finished() const { return state_ == State::DONE; }
+    bool failed() const { return state_ == State::FAILED; }
+
+private:
+    enum class State {
+        PREAMBLE,        // 第一个分隔行之前
+        AFTER_DELIMITER, // 分隔行之后，等待"\r\n"（下一部分）或"--"（结束）
+        HEADERS,
+        BODY,
+        DONE,
+        FAILED
+    };
+
+    // 处理一段连续数据，返回已消费的字节数；未消费的尾部由调用方保留到下次
+    size_t parse(const char* data, size_t length);
+    // 在[data, data + length)中查找分隔行，找不到返回length
+    size_t find_delimiter(const char* data, size_t length) const;
+
+    Handler& handler_;
+    std::string delimiter_;  // "\r\n--" + boundary
+    State state_;
+    std::string carry_;      // 上一段末尾可能属于分隔行的字节
+    std::string headers_;    // 正在累积的部分头部
+};
+
+#endif // MULTIPART_PARSER_H
@@ -0,0 +1,84 @@
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+#else
+    #include <sys/uio.h>
+#endif
+
+class FileBody;
+
+// 链式输出缓冲区
+// 由固定大小的内存段串成队列：追加写入尾段，发送完的字节只推进首段的读位置，
+// 首段发完后整段归还段池，消费和追加都是O(1)，不会像string::erase那样搬移剩余数据。
+// 大块数据直接接管其std::string作为一个节点，不拷贝进内存段；文件区间也作为节点排队，
+// 由连接用sendfile直接从文件发送。
+// 发送时把文件节点之前的若干个内存节点填成iovec（Windows为WSABUF），一次writev/sendmsg发出。
+// 不加锁，由所属连接的事件循环线程使用。
+class OutputBuffer {
+public:
+    // 一次发送最多使用的iovec数
+    static constexpr size_t MAX_IOVECS = 16;
+
+    OutputBuffer();
+    ~OutputBuffer();
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    // 拷贝进内存段
+    void append(const char* data, size_t length);
+    // 不足一个内存段的数据拷贝进内存段，更大的数据直接接管
+    void append(std::string&& data);
+    // 文件区间[offset, offset + length)，发送到该节点时由调用方从文件发送
+    void append_file(std::shared_ptr<FileBody> file, uint64_t offset, uint64_t length);
+
+    // 已发送n字节
+    void consume(uint64_t n);
+    // 丢弃所有数据，内存段归还段池
+    void clear();
+
+    uint64_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // 队首是文件节点时返回文件并给出尚未发送的区间，否则返回nullptr
+    const FileBody* front_file(uint64_t& offset, uint64_t& length) const;
+
+    // 从头开始填充最多max_count段、总长不超过max_bytes的发送缓冲区描述，返回段数；
+    // 遇到文件节点即停止
+#ifdef _WIN32
+    size_t fill(WSABUF* buffers, size_t max_count, size_t max_bytes) const;
+#else
+    size_t fill(struct iovec* buffers, size_t max_count, size_t max_bytes) const;
+#endif
+
+private:
+    struct Segment;
+
+    // 节点：内存段、接管的字符串或文件区间，[begin, end)为尚未发送的数据（文件节点为文件内偏移）
+    struct Chunk {
+        Segment* segment;
+        std::string owned;
+        std::shared_ptr<FileBody> file;
+        uint64_t begin;
+        uint64_t end;
+
+        const char* data() const;
+    };
+
+    static Segment* allocate_segment();
+    static void release_segment(Segment* segment);
+    void pop_front();
+
+    std::deque<Chunk> chunks_;
+    uint64_t size_;
+};
+
+#endif // OUTPUT_BUFFER_H
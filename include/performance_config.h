@@ -17,21 +17,34 @@ namespace PerformanceConfig {
     constexpr size_t DEFAULT_MAX_CONNECTIONS = 10000;        // 最大并发连接数
     constexpr size_t DEFAULT_THREAD_POOL_SIZE = 8;           // 工作线程池大小
     constexpr size_t DEFAULT_TASK_QUEUE_SIZE = 50000;        // 任务队列大小
+    constexpr size_t CONNECTION_TABLE_INITIAL_SLOTS = 1024;  // 连接表初始槽位数（按fd扩容）
+    constexpr size_t DISK_LANE_THREAD_COUNT = 4;             // 磁盘通道线程数（FileManager阻塞调用）
+    constexpr size_t DISK_LANE_QUEUE_SIZE = 1024;            // 磁盘通道队列深度
+    constexpr size_t CONNECTION_POOL_MAX_IDLE = 1024;        // 每个连接池缓存的空闲连接对象数
+    constexpr size_t CONNECTION_POOL_MAX_BUFFER = 256 * 1024; // 回收时保留的缓冲区容量上限，超出则释放
     
     // 缓冲区配置
     constexpr size_t DEFAULT_READ_BUFFER_SIZE = 64 * 1024;   // 64KB读取缓冲区
     constexpr size_t DEFAULT_WRITE_BUFFER_SIZE = 128 * 1024; // 128KB写入缓冲区
+    constexpr size_t OUTPUT_SEGMENT_SIZE = 16 * 1024;        // 输出缓冲区内存段大小
+    constexpr size_t OUTPUT_SEGMENT_POOL_SIZE = 256;         // 每个线程缓存的空闲内存段数
     constexpr size_t MAX_UPLOAD_SIZE = 100 * 1024 * 1024;   // 100MB最大上传大小
+    constexpr size_t UPLOAD_MAX_PENDING_BYTES = 1024 * 1024; // 上传body已读取、等待磁盘通道写入的上限，超出时暂停读取
+    constexpr size_t MAX_REQUEST_HEADER_SIZE = 64 * 1024;    // 请求行加头部的最大长度
+    constexpr size_t MAX_REQUEST_HEADERS = 64;               // 单个请求最多的头部字段数
     
     // 超时配置
     constexpr int CONNECTION_TIMEOUT_MS = 30000;             // 30秒连接超时
     constexpr int REQUEST_TIMEOUT_MS = 60000;                // 60秒请求超时
     constexpr int KEEP_ALIVE_TIMEOUT_MS = 300000;           // 5分钟保活超时
+    constexpr size_t TIMER_WHEEL_SLOTS = 1024;               // 时间轮槽位数
+    constexpr int TIMER_WHEEL_TICK_MS = 100;                 // 时间轮精度（一圈约102秒）
     
     // 文件I/O配置
     constexpr size_t FILE_CHUNK_SIZE = 1024 * 1024;         // 1MB文件块大小
     constexpr size_t MAX_CONCURRENT_UPLOADS = 100;           // 最大并发上传数
     constexpr size_t MAX_CONCURRENT_DOWNLOADS = 200;         // 最大并发下载数
+    constexpr size_t MAX_BYTE_RANGES = 16;                   // 单个Range请求最多的区间数，超出则发送整个文件
     
     // 性能监控配置
     constexpr int STATS_UPDATE_INTERVAL_MS = 1000;           // 1秒统计更新间隔
@@ -48,6 +61,9 @@ namespace PerformanceConfig {
     // 限流配置
     constexpr size_t MAX_REQUESTS_PER_SECOND = 10000;        // 每秒最大请求数
     constexpr size_t MAX_BYTES_PER_SECOND = 100 * 1024 * 1024; // 100MB/秒带宽限制
+    constexpr size_t MAX_REQUESTS_PER_CLIENT_PER_SECOND = 1000;    // 单个客户端IP每秒最大请求数
+    constexpr size_t MAX_BYTES_PER_CLIENT_PER_SECOND = 25 * 1024 * 1024; // 单个客户端IP 25MB/秒
+    constexpr size_t RATE_LIMIT_SHARDS = 64;                  // 客户端令牌桶分片数
     
     // 日志配置
     constexpr bool ENABLE_PERFORMANCE_LOGGING = true;        // 启用性能日志
@@ -60,6 +76,9 @@ namespace PerformanceConfig {
 #else
     constexpr size_t EPOLL_MAX_EVENTS = 10000;               // epoll最大事件数
     constexpr size_t EPOLL_TIMEOUT_MS = 100;                 // epoll超时时间
+    constexpr unsigned URING_QUEUE_DEPTH = 4096;             // io_uring提交队列深度
+    constexpr size_t URING_BUFFER_COUNT = 512;               // io_uring提供给内核的接收缓冲区数量
+    constexpr size_t URING_BUFFER_SIZE = 16 * 1024;          // 每个接收缓冲区16KB
 #endif
     
     // 性能等级配置
@@ -0,0 +1,112 @@
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 令牌桶：按固定速率补充令牌，最多积累burst个；不加锁，由持有者加锁保护
+class TokenBucket {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TokenBucket(double rate, double burst, Clock::time_point now);
+
+    // 补充令牌后最多取出wanted个，返回实际取出的数量
+    size_t take(size_t wanted, Clock::time_point now);
+    // 取出后未使用的令牌还回桶中
+    void give_back(size_t count);
+    bool full(Clock::time_point now);
+
+private:
+    void refill(Clock::time_point now);
+
+    double rate_;
+    double burst_;
+    double tokens_;
+    Clock::time_point last_refill_;
+};
+
+// 无锁令牌桶：令牌数和上次补充时间都是原子变量，用CAS补充和取出，
+// 供所有事件循环共用的全局桶使用，每次发送不必争抢同一把锁。令牌按整数计。
+class AtomicTokenBucket {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    AtomicTokenBucket(uint64_t rate, uint64_t burst, Clock::time_point now);
+
+    size_t take(size_t wanted, Clock::time_point now);
+    void give_back(size_t count);
+
+private:
+    void refill(Clock::time_point now);
+
+    uint64_t rate_;
+    uint64_t burst_;
+    std::atomic<uint64_t> tokens_;
+    std::atomic<int64_t> last_refill_;  // Clock的纳秒计数
+};
+
+// 按客户端IP分片的限流器
+// 每个客户端各有一个请求速率桶和一个字节速率桶，上面再叠加一组全局桶，
+// 请求和发送数据必须同时通过客户端桶和全局桶。客户端按IP哈希分散到多个分片，
+// 每个分片各自加锁，长时间空闲（桶已充满）的客户端条目在分片变大时清理；全局桶无锁。
+class RateLimiter {
+public:
+    struct Metrics {
+        size_t clients;
+        size_t limited_requests;   // 因请求速率被拒绝的请求
+        size_t throttled_sends;    // 因字节速率被推迟的发送
+    };
+
+    RateLimiter(size_t client_requests_per_second, size_t client_bytes_per_second,
+                size_t global_requests_per_second, size_t global_bytes_per_second,
+                size_t shard_count);
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    // 请求准入：客户端和全局请求桶各取一个令牌，任一不足则拒绝
+    bool allow_request(const std::string& client_ip);
+
+    // 发送配额：返回本次最多可发送的字节数，为0时需等待令牌补充后重试
+    size_t acquire_bytes(const std::string& client_ip, size_t wanted);
+    // 实际发送少于配额时归还剩余部分
+    void refund_bytes(const std::string& client_ip, size_t unused);
+
+    Metrics get_metrics() const;
+
+private:
+    struct ClientBuckets {
+        TokenBucket requests;
+        TokenBucket bytes;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string, ClientBuckets> clients;
+        size_t sweep_threshold = 1024;
+    };
+
+    Shard& shard_for(const std::string& client_ip);
+    ClientBuckets& buckets_for(Shard& shard, const std::string& client_ip, TokenBucket::Clock::time_point now);
+
+    size_t client_requests_per_second_;
+    size_t client_bytes_per_second_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    // 全局桶，各分片共用
+    AtomicTokenBucket global_requests_;
+    AtomicTokenBucket global_bytes_;
+
+    std::atomic<size_t> limited_requests_;
+    std::atomic<size_t> throttled_sends_;
+};
+
+#endif // RATE_LIMITER_H
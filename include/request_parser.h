@@ -0,0 +1,80 @@
+#ifndef REQUEST_PARSER_H
+#define REQUEST_PARSER_H
+
+#include "performance_config.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// HTTP/1.1请求头部增量解析器
+// 直接在连接的读取缓冲区上按行解析，数据分几次到达时从上次停下的位置继续，已扫描的字节不再重复扫描。
+// 请求行和各头部字段只记录在缓冲区中的偏移和长度，存放在固定大小的数组中，解析过程不分配内存；
+// 取出的string_view指向最近一次parse传入的缓冲区，缓冲区扩容后再调用一次parse即可重新指向新地址。
+class RequestParser {
+public:
+    enum class Status {
+        INCOMPLETE,  // 头部尚未收齐
+        COMPLETE,    // 已遇到结尾空行
+        INVALID      // 请求行格式错误、头部过长、字段过多或Content-Length、Host重复
+    };
+
+    RequestParser();
+
+    // 开始解析下一个请求
+    void reset();
+
+    // 解析buffer开头的请求头部。buffer须是上次传入数据的延续（已有字节不变，只在末尾追加），
+    // 完成或出错后再次调用只更新视图指向的地址
+    Status parse(std::string_view buffer);
+    Status status() const { return status_; }
+
+    std::string_view method() const { return view(method_); }
+    std::string_view path() const { return view(path_); }
+    std::string_view version() const { return view(version_); }
+
+    size_t header_count() const { return header_count_; }
+    std::string_view header_name(size_t index) const { return view(headers_[index].name); }
+    std::string_view header_value(size_t index) const { return view(headers_[index].value); }
+    // 按名称查找头部（不区分大小写），有重复字段时返回第一个
+    bool find_header(std::string_view name, std::string_view& value) const;
+
+    // 请求行加头部（含结尾空行）的长度，即body在缓冲区中的起始位置；未完成时为0
+    size_t header_length() const { return status_ == Status::COMPLETE ? line_start_ : 0; }
+
+private:
+    struct Span {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct Field {
+        Span name;
+        Span value;
+    };
+
+    enum class Stage {
+        REQUEST_LINE,
+        HEADERS,
+        DONE
+    };
+
+    std::string_view view(Span span) const { return std::string_view(base_ + span.offset, span.length); }
+    // 解析[begin, end)一行（不含换行符），返回false表示格式错误
+    bool parse_request_line(size_t begin, size_t end);
+    bool parse_header_line(size_t begin, size_t end);
+
+    const char* base_;
+    Status status_;
+    Stage stage_;
+    size_t line_start_;  // 当前行的起始位置
+    size_t scanned_;     // 已查找过换行符的位置，之前的字节不再扫描
+
+    Span method_;
+    Span path_;
+    Span version_;
+    Field headers_[PerformanceConfig::MAX_REQUEST_HEADERS];
+    size_t header_count_;
+};
+
+#endif // REQUEST_PARSER_H
@@ -0,0 +1,65 @@
+#ifndef RESPONSE_WRITER_H
+#define RESPONSE_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+struct HttpResponse;
+
+// 响应头部缓冲
+// 不超过INLINE_CAPACITY字节的内容直接存放在对象内部，常见的响应头部（以及小响应的body）不分配堆内存；
+// 超出时整体转存到std::string。拷贝和移动只复制已写入的字节。
+class ResponseHead {
+public:
+    static constexpr size_t INLINE_CAPACITY = 512;
+
+    ResponseHead() : size_(0) {}
+    ResponseHead(const ResponseHead& other);
+    ResponseHead& operator=(const ResponseHead& other);
+    ResponseHead(ResponseHead&& other) noexcept;
+    ResponseHead& operator=(ResponseHead&& other) noexcept;
+
+    void append(const char* data, size_t length);
+    void append(std::string_view text) { append(text.data(), text.size()); }
+
+    const char* data() const { return overflow_.empty() ? inline_ : overflow_.data(); }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    std::string str() const { return std::string(data(), size_); }
+
+private:
+    void assign(const ResponseHead& other);
+
+    char inline_[INLINE_CAPACITY];
+    size_t size_;
+    std::string overflow_;  // 超出内部容量后的全部内容
+};
+
+// 响应序列化
+// 常用状态码的状态行预先拼好，数字直接转成十进制字符，Date头每个线程每秒只格式化一次，
+// 全部追加进ResponseHead，不经过ostringstream。
+class ResponseWriter {
+public:
+    // 状态行、头部和结尾空行（含Content-Length、默认Content-Type和Date）
+    static void write_head(const HttpResponse& response, ResponseHead& out);
+
+    // 内容固定的小响应（404、/stats等）：状态行、头部和body一起写入out，不构造HttpResponse。
+    // extra_headers是已经带"\r\n"结尾的额外头部行
+    static void write_simple(int status_code, std::string_view content_type, std::string_view body,
+                             bool keep_alive, std::string_view extra_headers, ResponseHead& out);
+
+    // 常用状态码的原因短语，未知状态码返回空
+    static std::string_view status_text(int status_code);
+
+    static void append_uint(ResponseHead& out, uint64_t value);
+    // "Date: ...\r\n"
+    static void append_date(ResponseHead& out);
+
+private:
+    static void append_status_line(ResponseHead& out, int status_code, std::string_view text);
+    static void append_connection(ResponseHead& out, bool keep_alive);
+};
+
+#endif // RESPONSE_WRITER_H
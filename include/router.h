@@ -0,0 +1,63 @@
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 请求方法（枚举值带前缀，避免与Windows头文件中的DELETE宏冲突）
+enum class HttpMethod : uint8_t {
+    HTTP_GET,
+    HTTP_POST,
+    HTTP_PUT,
+    HTTP_DELETE,
+    HTTP_OTHER  // 不支持的方法
+};
+
+HttpMethod parse_method(std::string_view method);
+
+// 路由表
+// 每个方法一棵按路径段组织的前缀树，启动时注册一次，之后只读，可被多个线程同时查找。
+// 模式中的段可以是固定文本、"{name}"（匹配一个非空路径段）或"{name*}"（匹配剩余的全部路径，
+// 可以为空或含"/"，只能放在最后）。匹配时直接在请求路径上逐段比较，不创建子串；
+// 固定段优先于参数段。
+class Router {
+public:
+    static constexpr size_t MAX_PARAMS = 4;
+
+    struct Match {
+        int target;  // 注册时给出的编号
+        std::string_view params[MAX_PARAMS];  // 按模式中出现的顺序
+        size_t param_count;
+    };
+
+    Router();
+
+    void add(HttpMethod method, std::string_view pattern, int target);
+
+    // 找到路由返回true；不支持的方法总是返回false
+    bool match(HttpMethod method, std::string_view path, Match& match) const;
+
+private:
+    struct Node {
+        std::string segment;         // 固定段的文本
+        std::vector<size_t> children;  // 固定段子节点
+        size_t param_child;          // "{name}"子节点，没有时为NONE
+        int rest_target;             // "{name*}"对应的编号，没有时为-1
+        int target;                  // 路径在此结束时的编号，没有时为-1
+    };
+
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+    static constexpr size_t METHOD_COUNT = static_cast<size_t>(HttpMethod::HTTP_OTHER);
+
+    size_t new_node(std::string_view segment);
+    // 从路径位置pos（指向"/"或路径末尾）开始在node下匹配
+    bool match_from(size_t node, std::string_view path, size_t pos, Match& match) const;
+
+    std::vector<Node> nodes_;
+    size_t roots_[METHOD_COUNT];
+};
+
+#endif // ROUTER_H
@@ -10,6 +10,13 @@
 #include <mutex>
 #include <condition_variable>
 #include <chrono>
+#include <vector>
+
+#include "timer_wheel.h"
+#include "connection_table.h"
+#include "http_handler.h"
+#include "output_buffer.h"
+#include "request_parser.h"
 
 #ifdef _WIN32
     // Windows系统 - 使用IOCP
@@ -25,14 +32,22 @@
     #include <netinet/in.h>
     #include <unistd.h>
     #include <sys/epoll.h>
+    #include <sys/uio.h>
     #include <fcntl.h>
     typedef int socket_t;
     typedef int epoll_handle_t;
+    #ifndef INVALID_SOCKET
+    #define INVALID_SOCKET (-1)
+    #endif
 #endif
 
 // 前向声明
 class Connection;
 class TaskQueue;
+class EventLoop;
+class WorkStealingPool;
+class ConnectionPool;
+class AdmissionController;
 struct HttpRequest;
 struct HttpResponse;
 class HttpHandler;
@@ -41,11 +56,24 @@ class HttpHandler;
 enum class ConnectionState {
     CONNECTING,
     READING,
+    PROCESSING,     // 请求已完整读取，正在由工作线程处理
     WRITING,
     CLOSING,
     CLOSED
 };
 
+// 反应器模式
+enum class ReactorMode {
+    SHARED_ACCEPTOR,    // 单个事件循环接受连接，请求交给共享工作线程池处理
+    REUSEPORT_PER_CORE  // 每个核心一个SO_REUSEPORT监听socket和事件循环，连接全程由所属循环处理
+};
+
+// Linux事件循环的I/O后端
+enum class IoBackend {
+    EPOLL,     // 边缘触发epoll
+    IO_URING   // io_uring（内核不支持时自动回退到epoll）
+};
+
 // 异步任务类型
 enum class TaskType {
     READ_REQUEST,
@@ -81,10 +109,16 @@ public:
     void stop();
     bool is_running() const { return running_; }
     
+    // 在start()之前调用；loop_count为0时使用CPU核心数
+    void set_reactor_mode(ReactorMode mode, size_t loop_count = 0);
+    void set_io_backend(IoBackend backend) { io_backend_ = backend; }
+    
     // 性能统计
     size_t get_active_connections() const;
     size_t get_total_requests() const;
     double get_requests_per_second() const;
+    // 打印执行通道和准入控制统计
+    void print_lane_stats() const;
     
     // 性能配置常量 - 移到public部分
     static const size_t DEFAULT_MAX_CONNECTIONS = 1000;
@@ -94,7 +128,6 @@ public:
     
 private:
     void accept_connections();
-    void worker_thread_loop();
     void handle_async_task(AsyncTask& task);
     void cleanup_expired_connections();
     
@@ -107,10 +140,15 @@ private:
     bool setup_iocp();
     void handle_iocp_completion();
 #else
-    bool setup_epoll();
-    void handle_epoll_events();
+    bool start_event_loops();
+    
+    // 按任务类型把请求投递到CPU通道或磁盘通道，处理完再交回所属事件循环写回；
+    // 返回false表示由事件循环内联处理（每核模式下的轻量请求）
+    bool dispatch_request(EventLoop& loop, std::shared_ptr<Connection> conn);
 #endif
     
+    socket_t create_listen_socket(bool reuse_port);
+    
     std::string address_;  // 添加地址成员变量
     int port_;
     socket_t server_socket_;
@@ -121,11 +159,19 @@ private:
     std::atomic<size_t> active_connections_;
     std::atomic<size_t> total_requests_;
     std::mutex connections_mutex_;
-    std::vector<std::shared_ptr<Connection>> connections_;
+    ConnectionTable connections_;
+#ifdef _WIN32
+    TimerWheel timer_wheel_;  // 受connections_mutex_保护，由IOCP线程推进
+    std::shared_ptr<ConnectionPool> connection_pool_;
+#endif
     
     // 线程池
-    std::vector<std::thread> worker_threads_;
-    std::unique_ptr<TaskQueue> task_queue_;
+    // 执行通道：CPU通道负责解析和路由等非阻塞处理，磁盘通道负责FileManager的阻塞调用
+    std::unique_ptr<WorkStealingPool> cpu_lane_;
+    std::unique_ptr<WorkStealingPool> disk_lane_;
+    
+    // 准入控制：限制并发上传/下载数，连接持有其指针，需比事件循环和连接活得更久
+    std::unique_ptr<AdmissionController> admission_;
     
     // 性能配置
     size_t max_connections_;
@@ -135,9 +181,13 @@ private:
     iocp_handle_t iocp_handle_;
     std::thread iocp_thread_;  // 添加IOCP线程
 #else
-    epoll_handle_t epoll_handle_;
-    std::vector<struct epoll_event> epoll_events_;
+    // 事件循环（反应器），每个循环拥有自己的监听socket和连接
+    std::vector<std::unique_ptr<EventLoop>> loops_;
 #endif
+    
+    ReactorMode reactor_mode_;
+    size_t reactor_count_;
+    IoBackend io_backend_;
 };
 
 // 连接类
@@ -146,21 +196,88 @@ public:
     Connection(socket_t socket, const std::string& client_ip);
     ~Connection();
     
+    // 连接池复用：reset绑定新socket并重置状态，recycle关闭socket、清空缓冲区，
+    // 两者都保留缓冲区已分配的容量（过大的缓冲区在recycle时释放）
+    void reset(socket_t socket, const std::string& client_ip);
+    void recycle();
+    
     // 异步操作
     void async_read();
-    void async_write(const std::string& data);
+    // 响应数据直接移入写缓冲区，不做拷贝
+    void async_write(ResponseBuffer data);
     void async_close();
+    void close();
+    
+    // 可写事件到来时继续发送未完成的数据（边缘触发下由epoll线程调用）
+    void continue_write();
+    
+    // 完成式I/O（io_uring）接口：由事件循环提交读写，只把结果交给连接
+    void on_data_received(const char* data, size_t length);
+    void begin_write(ResponseBuffer data);
+    void on_data_sent(size_t bytes_sent);
+    
+    // 待发送数据填入最多OutputBuffer::MAX_IOVECS段iovec，总长不超过max_bytes，返回段数
+#ifdef _WIN32
+    size_t fill_write_buffers(WSABUF* buffers, size_t max_bytes) const;
+#else
+    size_t fill_write_buffers(struct iovec* buffers, size_t max_bytes) const;
+#endif
+    uint64_t pending_write_bytes() const { return write_buffer_.size(); }
+    // 队首待发送的是文件区间时返回文件（由sendfile发送），否则返回nullptr
+    const FileBody* front_write_file(uint64_t& offset, uint64_t& length) const {
+        return write_buffer_.front_file(offset, length);
+    }
+    // 非保持连接的响应发送完后关闭socket
+    bool close_after_write() const { return !keep_alive_; }
+    // socket的关闭已交给内核（链接的close操作），连接不再持有它
+    void release_socket() { socket_ = INVALID_SOCKET; }
+    
+    // 解析并处理已读取的完整请求，返回序列化后的响应
+    ResponseBuffer process_request();
+    // 根据路由结果判断任务类型（上传/下载/删除等），不解析头部
+    TaskType classify_request() const;
+    // 过载或头部检查未通过时不处理已读取的请求，直接返回错误响应（例如503）并在发送后关闭连接
+    ResponseBuffer reject_request(int status_code);
+    
+    // 准入控制：头部到齐时检查客户端请求速率（超限回复429）并按请求类型申请并发名额（超限回复503），
+    // 被拒绝的请求不再读取body
+    void set_admission_controller(AdmissionController* admission) { admission_ = admission; }
+    bool is_shed() const { return shed_; }
+    
+    // 发送限速：返回本次可发送的字节数（客户端和全局字节桶），为0时连接标记为受限，
+    // 由事件循环在下一个tick重试；实际发送少于配额时归还剩余部分
+    size_t acquire_send_quota(size_t wanted);
+    void refund_send_quota(size_t unused);
+    bool is_send_throttled() const { return send_throttled_; }
+    
+    // 请求就绪时的分发回调，未设置时在当前线程内联处理
+    void set_dispatcher(std::function<void(std::shared_ptr<Connection>)> dispatcher) {
+        dispatcher_ = std::move(dispatcher);
+    }
     
-    // 状态查询
-    bool is_active() const { return state_ != ConnectionState::CLOSED; }
-    ConnectionState get_state() const { return state_; }
+    // 流式body的磁盘写入：runner在磁盘通道执行任务，完成后回到事件循环线程调用on_body_task_done，
+    // 队列已满时返回false；未设置时在当前线程直接写入
+    using BodyTaskRunner = std::function<bool(std::shared_ptr<Connection>, std::function<void()>)>;
+    void set_body_task_runner(BodyTaskRunner runner) { body_task_runner_ = std::move(runner); }
+    void on_body_task_done();
+    // BodySink正在磁盘通道创建，或已读取的body等待写入的数据达到上限，事件循环暂停读取，数据留在内核缓冲区
+    bool is_read_paused() const;
+    
+    // 状态查询（工作线程也会查询，例如处理前确认连接未被关闭）
+    bool is_active() const { return get_state() != ConnectionState::CLOSED; }
+    ConnectionState get_state() const { return state_.load(std::memory_order_acquire); }
     std::string get_client_ip() const { return client_ip_; }
+    socket_t get_socket() const { return socket_; }
+    
+    // 连接在所属连接表中的句柄（fd + 代数），用于O(1)删除
+    void set_handle(uint64_t handle) { handle_ = handle; }
+    uint64_t get_handle() const { return handle_; }
     
     // 数据访问
     std::string& get_read_buffer() { return read_buffer_; }
-    std::string& get_write_buffer() { return write_buffer_; }
     
-    // 超时检查
+    // 超时检查：按当前阶段（空闲/读取头部/读取body/发送）计算截止时间，处理中的请求不超时
+    std::chrono::steady_clock::time_point deadline() const;
     bool is_expired() const;
     void update_activity();
     
@@ -168,17 +285,92 @@ private:
     void set_state(ConnectionState state);
     void handle_read_completion(size_t bytes_read);
     void handle_write_completion(size_t bytes_written);
+    bool request_complete() const;
+    // 完整请求已到达，或请求已被准入控制拒绝
+    bool request_ready();
+    // 头部到齐后查一次路由，准入、头部检查、创建BodySink和处理请求共用结果
+    void route_request();
+    void admit_request();
+    void release_admission();
+    // 头部到齐后检查请求（格式、传输编码、长度上限、路由、Expect），未通过时按对应状态码拒绝
+    void check_headers();
+    // 头部检查和准入通过后，为需要流式接收的请求创建body_sink_，并把已读到的body交给它
+    void stream_body();
+    // 待写队列和管道中的body交给磁盘通道；已有写入任务在执行时等它完成后再提交
+    void submit_body_chunks();
+    // 在磁盘通道执行BodySink的创建或写入，bytes为本次写入的字节数
+    void start_body_task(uint64_t bytes, std::function<void()> work);
+    // 任务完成后的记账；创建任务完成时接手BodySink并回复100 Continue
+    void complete_body_task();
+    // Expect: 100-continue的中间响应
+    void send_continue();
+    // 发送文件时先攒满报文再发出（TCP_CORK），响应发完后取消，让最后不足一个MSS的数据立即发出
+    void set_cork(bool enabled);
+    // 内容固定的小响应（404、/stats等），直接序列化，不构造HttpResponse
+    ResponseBuffer simple_response(int status_code, std::string_view content_type, std::string_view body);
+    // 读取缓冲区中第一个完整请求的长度，不完整时返回0
+    size_t buffered_request_length() const;
     
     socket_t socket_;
+    uint64_t handle_;
     std::string client_ip_;
-    ConnectionState state_;
+    // 由事件循环线程修改，工作线程只读取；其余成员在请求交给工作线程期间只由工作线程访问
+    std::atomic<ConnectionState> state_;
     
     // 缓冲区
     std::string read_buffer_;
-    std::string write_buffer_;
+    OutputBuffer write_buffer_;   // 链式输出缓冲区，发送完的部分O(1)消费
+    std::string request_buffer_;  // 正在处理的请求，流水线中的后续请求留在read_buffer_
+    RequestParser parser_;          // read_buffer_开头请求的头部，随数据到达增量解析
+    RequestParser request_parser_;  // request_buffer_中请求的头部，取出请求时从parser_接手
+    
+    // HTTP/1.1持久连接
+    bool keep_alive_;
+    size_t requests_served_;
     
     // 活动时间
     std::chrono::steady_clock::time_point last_activity_;
+    std::chrono::steady_clock::time_point request_start_;  // 当前请求第一个字节到达的时间
+    
+    std::function<void(std::shared_ptr<Connection>)> dispatcher_;
+    
+    // 正在读取的请求的路由结果；取出完整请求时移交给request_route_，与parser_/request_parser_对应
+    HttpHandler::Route route_;
+    HttpHandler::Route request_route_;
+    bool routed_;
+    
+    // 准入控制状态（针对当前请求），名额在响应发送完或连接回收时归还
+    AdmissionController* admission_;
+    TaskType admitted_type_;
+    bool admission_checked_;
+    bool holds_admission_;
+    bool shed_;
+    int shed_status_;
+    bool send_throttled_;
+    bool corked_;
+    
+    // 流式接收的请求body（例如multipart上传）：body到达即交给body_sink_，不在read_buffer_中累积，
+    // read_buffer_中只保留前body_start_字节的头部
+    std::unique_ptr<BodySink> body_sink_;
+    uint64_t body_remaining_;
+    size_t body_start_;
+    bool body_checked_;
+    bool headers_checked_;
+    bool has_content_length_;
+    uint64_t content_length_;  // 头部检查时解析的Content-Length
+    
+    // body的磁盘写入在磁盘通道进行。同一连接同一时刻最多一个写入任务，body_sink_不会被两个线程同时访问，
+    // 写入顺序与到达顺序一致；任务执行期间到达的数据在body_chunks_中排队
+    BodyTaskRunner body_task_runner_;
+    std::vector<std::string> body_chunks_;
+    uint64_t body_received_;       // 已splice进BodySink管道、尚未交给写入任务的字节数
+    uint64_t body_pending_bytes_;  // 排队、在管道中和正在写入的字节数
+    uint64_t body_task_bytes_;     // 正在执行的写入任务的字节数
+    bool body_task_running_;
+    bool body_opening_;            // BodySink正在磁盘通道创建，结果放在opened_sink_
+    bool body_splice_;             // BodySink支持直接从socket接收
+    bool expect_continue_;         // BodySink创建好后回复100 Continue
+    std::unique_ptr<BodySink> opened_sink_;
     
     // 平台特定的I/O状态
 #ifdef _WIN32
@@ -191,21 +383,66 @@ private:
 #endif
 };
 
-// 任务队列类
+// 计数信号量：Linux使用EFD_SEMAPHORE模式的eventfd，Windows使用内核信号量
+class Semaphore {
+public:
+    Semaphore();
+    ~Semaphore();
+    
+    Semaphore(const Semaphore&) = delete;
+    Semaphore& operator=(const Semaphore&) = delete;
+    
+    void post(unsigned count = 1);
+    void wait();
+    
+private:
+#ifdef _WIN32
+    HANDLE handle_;
+#else
+    int fd_;
+#endif
+};
+
+// 任务队列类：无锁有界MPMC环形队列
+// 每个槽位带序号，生产者和消费者各自通过CAS推进位置，不需要互斥锁。
+// 队列为空时消费者睡眠在信号量（Linux为eventfd）上，只有存在睡眠者时生产者才发出唤醒。
 class TaskQueue {
 public:
+    // 容量向上取整为2的幂
     TaskQueue(size_t max_size = 10000);
+    ~TaskQueue();
     
-    void push(AsyncTask task);
+    TaskQueue(const TaskQueue&) = delete;
+    TaskQueue& operator=(const TaskQueue&) = delete;
+    
+    // 队列已满或已关闭时返回false，此时task保持不变，由调用方施加背压
+    bool push(AsyncTask&& task);
+    // 阻塞直到取到任务；队列关闭后返回false
     bool pop(AsyncTask& task);
+    bool try_pop(AsyncTask& task);
+    
+    // 唤醒所有等待的消费者，此后pop立即返回false
+    void shutdown();
+    
     bool empty() const;
     size_t size() const;
+    size_t capacity() const { return mask_ + 1; }
     
 private:
-    std::queue<AsyncTask> tasks_;
-    mutable std::mutex mutex_;
-    std::condition_variable not_empty_;
-    size_t max_size_;
+    struct Cell {
+        std::atomic<size_t> sequence;
+        AsyncTask task;
+    };
+    
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    
+    // 生产者和消费者的位置放在不同缓存行，避免伪共享
+    alignas(64) std::atomic<size_t> enqueue_pos_;
+    alignas(64) std::atomic<size_t> dequeue_pos_;
+    alignas(64) std::atomic<int> sleepers_;
+    std::atomic<bool> closed_;
+    Semaphore wakeup_;
 };
 
 #endif // SERVER_H 
\ No newline at end of file
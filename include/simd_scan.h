@@ -0,0 +1,24 @@
+#ifndef SIMD_SCAN_H
+#define SIMD_SCAN_H
+
+#include <cstddef>
+
+// 向量化的子串查找
+// 每次取一整块（AVX2为32字节，SSE2为16字节），同时比较子串的首字节和末字节，
+// 两者都相同的位置才逐字节比较中间部分；分隔行、"\r\n\r\n"这类子串在普通数据中很少出现首末字节同时匹配，
+// 绝大部分数据只经过两次向量比较。编译器未启用SSE2/AVX2时（例如非x86平台）退回memchr定位首字节。
+// 函数本身不保存状态：调用方记录已扫描到的位置，新数据到达时只从那里继续查找。
+namespace SimdScan {
+    // 在[data, data + length)中查找needle第一次出现的位置，找不到返回length
+    size_t find(const char* data, size_t length, const char* needle, size_t needle_length);
+
+    // 查找头部结尾"\r\n\r\n"，找不到返回length
+    inline size_t find_header_end(const char* data, size_t length) {
+        return find(data, length, "\r\n\r\n", 4);
+    }
+
+    // 编译时选用的指令集，用于启动日志
+    const char* instruction_set();
+}
+
+#endif // SIMD_SCAN_H
@@ -0,0 +1,48 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class Connection;
+
+// 哈希时间轮：管理连接的空闲、读取头部、读取body等超时
+// 每个连接只挂入一次，超时时间变化时不移动节点；槽位到期时再读取连接当前的截止时间，
+// 未到期则重新挂入对应槽位。插入和每次检查都是O(1)，不需要全局锁，由所属线程独占使用。
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using ExpireHandler = std::function<void(const std::shared_ptr<Connection>&)>;
+
+    TimerWheel(size_t slot_count, std::chrono::milliseconds tick);
+
+    // 按连接当前的deadline()挂入时间轮
+    void schedule(const std::shared_ptr<Connection>& conn);
+
+    // 推进到now，对到期槽位中已超时或已关闭的连接调用on_expired，并将其移出时间轮
+    void advance(Clock::time_point now, const ExpireHandler& on_expired);
+
+    void clear();
+    size_t size() const { return size_; }
+
+private:
+    struct Entry {
+        std::weak_ptr<Connection> conn;
+        uint64_t expire_tick;
+    };
+
+    uint64_t tick_of(Clock::time_point when) const;
+    void insert(const std::shared_ptr<Connection>& conn, Clock::time_point deadline);
+
+    std::vector<std::vector<Entry>> slots_;
+    std::vector<Entry> due_;  // 复用的到期槽位缓冲，避免每个tick分配内存
+    std::chrono::milliseconds tick_;
+    Clock::time_point start_;
+    uint64_t current_tick_;
+    size_t size_;
+};
+
+#endif // TIMER_WHEEL_H
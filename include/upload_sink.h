@@ -0,0 +1,71 @@
+#ifndef UPLOAD_SINK_H
+#define UPLOAD_SINK_H
+
+#include "http_handler.h"
+#include "multipart_parser.h"
+#include "file_manager.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// multipart/form-data上传：body边到达边解析，每个带文件名的部分直接流式写入上传目录，
+// 内存占用只有解析器的小窗口，与上传大小无关。文件写完整后才改名为目标文件名。
+// 构造时不访问文件系统，可以在事件循环线程创建；write和finish会读写磁盘，由磁盘通道调用。
+class MultipartUploadSink : public BodySink, private MultipartParser::Handler {
+public:
+    explicit MultipartUploadSink(const std::string& boundary);
+
+    bool write(const char* data, size_t length) override;
+    HttpResponse finish() override;
+
+private:
+    void on_part_begin(const std::string& headers) override;
+    void on_part_data(const char* data, size_t length) override;
+    void on_part_end() override;
+
+    MultipartParser parser_;
+    HttpHandler http_handler_;
+    std::unique_ptr<FileManager> file_manager_;  // 第一个文件部分开始时创建（构造时会检查上传目录）
+
+    // 正在写入的部分；写入失败后置空，该部分剩余数据丢弃
+    std::unique_ptr<FileWriter> writer_;
+    std::string current_filename_;
+    bool current_failed_;
+
+    std::vector<std::string> saved_files_;
+    std::vector<std::string> failed_files_;
+};
+
+// PUT上传：body就是文件内容，没有multipart封装。Linux下事件循环把body从socket splice进管道，
+// 磁盘通道再从管道splice进文件，数据不进入用户态；其他情况（已读入缓冲区的部分、io_uring、Windows）
+// 按普通写入处理。构造前文件已创建，需在磁盘通道进行。
+class RawUploadSink : public BodySink {
+public:
+    // 管道容量，即单次splice搬运的上限
+    static constexpr size_t PIPE_SIZE = 1024 * 1024;
+
+    RawUploadSink(const std::string& filename, std::unique_ptr<FileWriter> writer,
+                  uint64_t expected_length, bool replacing);
+    ~RawUploadSink() override;
+
+    RawUploadSink(const RawUploadSink&) = delete;
+    RawUploadSink& operator=(const RawUploadSink&) = delete;
+
+    bool write(const char* data, size_t length) override;
+    long long receive_from(int socket, uint64_t max_length) override;
+    bool write_received(uint64_t length) override;
+    HttpResponse finish() override;
+
+private:
+    void close_pipe();
+
+    std::string filename_;
+    std::unique_ptr<FileWriter> writer_;  // 写入失败后置空，剩余body丢弃
+    uint64_t expected_length_;
+    bool replacing_;                      // 覆盖已有文件（200），否则为新建（201）
+    bool splice_supported_;
+    int pipe_[2];
+};
+
+#endif // UPLOAD_SINK_H
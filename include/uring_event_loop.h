@@ -0,0 +1,142 @@
+#ifndef URING_EVENT_LOOP_H
+#define URING_EVENT_LOOP_H
+
+#include "event_loop.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef HAVE_IO_URING
+
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+
+// 最小化的io_uring封装：直接使用系统调用和共享内存环，不依赖liburing
+class IoUring {
+public:
+    IoUring();
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    bool init(unsigned entries);
+    void close();
+
+    // 提交队列已满时返回nullptr，调用方应先submit()
+    struct io_uring_sqe* get_sqe();
+
+    // 提交所有已准备的SQE，wait_nr > 0 时阻塞等待至少wait_nr个完成事件
+    int submit(unsigned wait_nr = 0);
+
+    // 遍历并消费所有已完成的CQE
+    template <typename Handler>
+    unsigned for_each_cqe(Handler&& handler) {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        unsigned count = 0;
+
+        while (head != tail) {
+            handler(&cqes_[head & cq_mask_]);
+            ++head;
+            ++count;
+            // 处理过程中可能产生新的完成事件，一并消费
+            if (head == tail) {
+                tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            }
+        }
+
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+private:
+    int ring_fd_;
+
+    // 提交队列
+    void* sq_ring_ptr_;
+    size_t sq_ring_size_;
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned sq_mask_;
+    unsigned sq_entries_;
+    struct io_uring_sqe* sqes_;
+    size_t sqes_size_;
+    unsigned sqe_tail_;  // 本地已准备但尚未发布的尾指针
+
+    // 完成队列
+    void* cq_ring_ptr_;
+    size_t cq_ring_size_;
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned cq_mask_;
+    struct io_uring_cqe* cqes_;
+};
+
+// 基于io_uring的事件循环
+// 使用multishot accept接受连接，接收使用内核选择的预注册缓冲区，
+// 响应发送与close通过IOSQE_IO_LINK链接，整批提交以减少系统调用次数。
+class UringEventLoop : public EventLoop {
+public:
+    UringEventLoop(size_t id, socket_t listen_socket, size_t max_connections);
+    ~UringEventLoop() override;
+
+    // 探测当前内核是否可用io_uring
+    static bool is_supported();
+
+protected:
+    bool setup() override;
+    void run() override;
+    void wakeup() override;
+    void send_response(const std::shared_ptr<Connection>& conn, ResponseBuffer response_data) override;
+    void close_all_connections() override;
+    void resume_write(const std::shared_ptr<Connection>& conn) override;
+    void resume_read(const std::shared_ptr<Connection>& conn) override;
+
+private:
+    // 每个连接在环上的状态；其地址与操作类型一起编码进user_data
+    struct ConnectionSlot {
+        std::shared_ptr<Connection> conn;
+        socket_t fd;
+        int inflight;          // 尚未完成的SQE数量，为0时才能释放
+        bool recv_armed;
+        bool send_armed;
+        bool send_polling;     // 在途的OP_SEND是等待可写的poll（队首为文件，由sendfile发送）
+        bool close_submitted;  // 已提交链接的close
+        bool fd_closed;
+        bool closing;
+        // 在途sendmsg引用的消息头和iovec，必须保持到完成事件到达
+        struct msghdr send_msg;
+        struct iovec send_iov[OutputBuffer::MAX_IOVECS];
+    };
+
+    struct io_uring_sqe* next_sqe();
+    void handle_completion(const struct io_uring_cqe* cqe);
+    void handle_accept(int res, unsigned flags);
+    void handle_recv(ConnectionSlot* slot, int res, unsigned flags);
+
+    void arm_accept();
+    void arm_wakeup();
+    void arm_timeout();
+    void arm_recv(ConnectionSlot* slot);
+    void submit_send(ConnectionSlot* slot);
+    void provide_buffers(unsigned short bid, unsigned count);
+    void cancel(ConnectionSlot* slot, unsigned op);
+
+    void after_io(ConnectionSlot* slot);
+    void cleanup_expired_connections();
+
+    // 声明顺序保证析构时先关闭环，再释放环上操作引用的缓冲区和连接
+    std::vector<char> buffer_pool_;
+    std::unordered_map<Connection*, std::unique_ptr<ConnectionSlot>> slots_;
+    int wakeup_fd_;
+    uint64_t wakeup_value_;
+    struct __kernel_timespec tick_;
+    IoUring ring_;
+};
+
+#endif // HAVE_IO_URING
+
+#endif // URING_EVENT_LOOP_H
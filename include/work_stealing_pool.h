@@ -0,0 +1,76 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include "server.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 工作窃取线程池（执行通道）
+// 每个工作线程拥有自己的无锁任务队列，提交时按轮转分配；线程自己的队列为空时
+// 依次从其他线程的队列中窃取任务，因此大上传解析不会挡住排在同一队列后面的小请求。
+// 所有线程都找不到任务时睡眠在共享信号量上，只有存在睡眠线程时提交方才发出唤醒。
+class WorkStealingPool {
+public:
+    using TaskHandler = std::function<void(AsyncTask&)>;
+
+    // 通道统计快照
+    struct Metrics {
+        std::string name;
+        size_t threads;
+        size_t queue_capacity;
+        size_t pending;        // 排队中的任务数
+        size_t active;         // 正在执行的任务数
+        size_t submitted;
+        size_t rejected;       // 队列满被拒绝的任务数
+        size_t completed;
+        size_t stolen;
+        double avg_wait_ms;    // 任务平均排队时间
+    };
+
+    // queue_capacity为所有工作线程队列的总容量
+    WorkStealingPool(const std::string& name, size_t thread_count, size_t queue_capacity);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void start(TaskHandler handler);
+    void stop();
+
+    // 线程安全；所有队列都已满或线程池已停止时返回false，由调用方施加背压
+    bool submit(AsyncTask task);
+
+    const std::string& name() const { return name_; }
+    size_t thread_count() const { return queues_.size(); }
+    size_t pending_tasks() const;
+    Metrics get_metrics() const;
+
+private:
+    void worker_loop(size_t index);
+    bool next_task(size_t index, AsyncTask& task);
+
+    std::string name_;
+    std::vector<std::unique_ptr<TaskQueue>> queues_;
+    std::vector<std::thread> threads_;
+    TaskHandler handler_;
+
+    alignas(64) std::atomic<size_t> next_queue_;
+    alignas(64) std::atomic<int> sleepers_;
+    std::atomic<bool> stopping_;
+    Semaphore wakeup_;
+
+    // 统计信息
+    std::atomic<size_t> active_tasks_;
+    std::atomic<size_t> submitted_tasks_;
+    std::atomic<size_t> rejected_tasks_;
+    std::atomic<size_t> completed_tasks_;
+    std::atomic<size_t> stolen_tasks_;
+    std::atomic<uint64_t> total_wait_us_;
+};
+
+#endif // WORK_STEALING_POOL_H
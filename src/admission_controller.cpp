@@ -0,0 +1,92 @@
+#include "../include/admission_controller.h"
+#include "../include/performance_config.h"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // 连接数超限时直接写出的固定响应
+    const char SERVICE_UNAVAILABLE_RESPONSE[] =
+        "HTTP/1.1 503 Service Unavailable\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: 23\r\n"
+        "Retry-After: 1\r\n"
+        "Connection: close\r\n"
+        "\r\n"
+        "503 Service Unavailable";
+}
+
+AdmissionController::AdmissionController(size_t max_uploads, size_t max_downloads)
+    : rejected_connections_(0),
+      rate_limiter_(PerformanceConfig::MAX_REQUESTS_PER_CLIENT_PER_SECOND,
+                    PerformanceConfig::MAX_BYTES_PER_CLIENT_PER_SECOND,
+                    PerformanceConfig::MAX_REQUESTS_PER_SECOND,
+                    PerformanceConfig::MAX_BYTES_PER_SECOND,
+                    PerformanceConfig::RATE_LIMIT_SHARDS) {
+    uploads_.max = max_uploads;
+    downloads_.max = max_downloads;
+}
+
+AdmissionController::Limit* AdmissionController::limit_for(TaskType type) {
+    switch (type) {
+        case TaskType::FILE_UPLOAD:
+            return &uploads_;
+        case TaskType::FILE_DOWNLOAD:
+            return &downloads_;
+        default:
+            return nullptr;
+    }
+}
+
+bool AdmissionController::try_acquire(TaskType type) {
+    Limit* limit = limit_for(type);
+    if (!limit) return true;
+
+    size_t current = limit->in_flight.load(std::memory_order_relaxed);
+    while (current < limit->max) {
+        if (limit->in_flight.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel)) {
+            return true;
+        }
+    }
+
+    limit->rejected.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void AdmissionController::release(TaskType type) {
+    Limit* limit = limit_for(type);
+    if (limit) {
+        limit->in_flight.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void AdmissionController::reject_connection(socket_t socket) {
+    rejected_connections_.fetch_add(1, std::memory_order_relaxed);
+    PerformanceConfig::global_metrics.rejected_connections++;
+
+    // 新连接的发送缓冲区是空的，固定响应一次即可写完；写不进去也不等待
+#ifdef _WIN32
+    send(socket, SERVICE_UNAVAILABLE_RESPONSE, sizeof(SERVICE_UNAVAILABLE_RESPONSE) - 1, 0);
+    shutdown(socket, SD_SEND);
+    closesocket(socket);
+#else
+    send(socket, SERVICE_UNAVAILABLE_RESPONSE, sizeof(SERVICE_UNAVAILABLE_RESPONSE) - 1,
+         MSG_NOSIGNAL | MSG_DONTWAIT);
+    shutdown(socket, SHUT_WR);
+    ::close(socket);
+#endif
+}
+
+AdmissionController::Metrics AdmissionController::get_metrics() const {
+    Metrics metrics;
+    metrics.uploads_in_flight = uploads_.in_flight.load(std::memory_order_relaxed);
+    metrics.downloads_in_flight = downloads_.in_flight.load(std::memory_order_relaxed);
+    metrics.max_uploads = uploads_.max;
+    metrics.max_downloads = downloads_.max;
+    metrics.rejected_uploads = uploads_.rejected.load(std::memory_order_relaxed);
+    metrics.rejected_downloads = downloads_.rejected.load(std::memory_order_relaxed);
+    metrics.rejected_connections = rejected_connections_.load(std::memory_order_relaxed);
+    return metrics;
+}
@@ -0,0 +1,49 @@
+#include "../include/connection_pool.h"
+
+ConnectionPool::ConnectionPool(size_t max_idle)
+    : max_idle_(max_idle), created_(0), reused_(0) {
+    idle_.reserve(max_idle_);
+}
+
+ConnectionPool::~ConnectionPool() = default;
+
+std::shared_ptr<Connection> ConnectionPool::acquire(socket_t socket, const std::string& client_ip) {
+    std::unique_ptr<Connection> conn;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!idle_.empty()) {
+            conn = std::move(idle_.back());
+            idle_.pop_back();
+        }
+    }
+
+    if (conn) {
+        conn->reset(socket, client_ip);
+        reused_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        conn.reset(new Connection(socket, client_ip));
+        created_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 删除器持有池的引用；对象复用时enable_shared_from_this的弱引用已过期，会绑定到新的控制块
+    auto self = shared_from_this();
+    return std::shared_ptr<Connection>(conn.release(), [self](Connection* c) {
+        self->release(c);
+    });
+}
+
+void ConnectionPool::release(Connection* conn) {
+    // 先在锁外关闭socket、清空缓冲区，旧的弱引用（时间轮等）此时已全部失效
+    conn->recycle();
+
+    std::unique_ptr<Connection> owned(conn);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle_.size() < max_idle_) {
+        idle_.push_back(std::move(owned));
+    }
+}
+
+size_t ConnectionPool::idle_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_.size();
+}
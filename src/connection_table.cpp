@@ -0,0 +1,80 @@
+#include "../include/connection_table.h"
+#include "../include/server.h"
+#include "../include/performance_config.h"
+
+ConnectionTable::ConnectionTable() : size_(0) {}
+
+size_t ConnectionTable::index_of(uintptr_t fd) {
+#ifdef _WIN32
+    // Windows的SOCKET是内核句柄，取值为4的倍数
+    return static_cast<size_t>(fd) >> 2;
+#else
+    return static_cast<size_t>(fd);
+#endif
+}
+
+ConnectionHandle ConnectionTable::insert(uintptr_t fd, std::shared_ptr<Connection> conn) {
+    size_t index = index_of(fd);
+    if (index >= slots_.size()) {
+        // 按倍数扩容，分摊后每次插入仍是O(1)
+        size_t capacity = slots_.empty() ? PerformanceConfig::CONNECTION_TABLE_INITIAL_SLOTS : slots_.size();
+        while (capacity <= index) capacity *= 2;
+        slots_.resize(capacity);
+    }
+
+    Slot& slot = slots_[index];
+    if (slot.conn) {
+        return INVALID_CONNECTION_HANDLE;
+    }
+
+    slot.conn = std::move(conn);
+    size_++;
+    return (static_cast<ConnectionHandle>(slot.generation) << 32) | static_cast<uint32_t>(index);
+}
+
+const ConnectionTable::Slot* ConnectionTable::lookup(ConnectionHandle handle) const {
+    size_t index = static_cast<uint32_t>(handle);
+    uint32_t generation = static_cast<uint32_t>(handle >> 32);
+
+    if (handle == INVALID_CONNECTION_HANDLE || index >= slots_.size()) {
+        return nullptr;
+    }
+
+    const Slot& slot = slots_[index];
+    if (!slot.conn || slot.generation != generation) {
+        return nullptr;
+    }
+    return &slot;
+}
+
+std::shared_ptr<Connection> ConnectionTable::get(ConnectionHandle handle) const {
+    const Slot* slot = lookup(handle);
+    return slot ? slot->conn : nullptr;
+}
+
+std::shared_ptr<Connection> ConnectionTable::find(uintptr_t fd) const {
+    size_t index = index_of(fd);
+    return index < slots_.size() ? slots_[index].conn : nullptr;
+}
+
+bool ConnectionTable::erase(ConnectionHandle handle) {
+    Slot* slot = const_cast<Slot*>(lookup(handle));
+    if (!slot) {
+        return false;
+    }
+
+    slot->conn.reset();
+    slot->generation++;  // 使指向该槽位的旧句柄失效
+    size_--;
+    return true;
+}
+
+void ConnectionTable::clear() {
+    for (Slot& slot : slots_) {
+        if (slot.conn) {
+            slot.conn.reset();
+            slot.generation++;
+        }
+    }
+    size_ = 0;
+}
@@ -0,0 +1,425 @@
+#include "../include/event_loop.h"
+#include "../include/admission_controller.h"
+#include "../include/performance_config.h"
+#include <iostream>
+#include <algorithm>
+
+#ifndef _WIN32
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+namespace {
+
+// epoll事件中非连接fd的标记，连接事件携带ConnectionTable句柄
+constexpr uint64_t LISTEN_TOKEN = INVALID_CONNECTION_HANDLE - 1;
+constexpr uint64_t WAKEUP_TOKEN = INVALID_CONNECTION_HANDLE - 2;
+
+} // namespace
+
+EventLoop::EventLoop(size_t id, socket_t listen_socket, size_t max_connections)
+    : id_(id), listen_socket_(listen_socket), max_connections_(max_connections), running_(false),
+      timer_wheel_(PerformanceConfig::TIMER_WHEEL_SLOTS,
+                   std::chrono::milliseconds(PerformanceConfig::TIMER_WHEEL_TICK_MS)),
+      connection_pool_(std::make_shared<ConnectionPool>(PerformanceConfig::CONNECTION_POOL_MAX_IDLE)),
+      active_connections_(0), total_requests_(0) {}
+
+EventLoop::~EventLoop() {
+    if (listen_socket_ != INVALID_SOCKET) {
+        ::close(listen_socket_);
+    }
+}
+
+bool EventLoop::start(int cpu) {
+    if (!setup()) {
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&EventLoop::run, this);
+
+    if (cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu, &cpuset);
+        if (pthread_setaffinity_np(thread_.native_handle(), sizeof(cpuset), &cpuset) != 0) {
+            std::cerr << "事件循环 " << id_ << " 绑定CPU " << cpu << " 失败" << std::endl;
+        }
+    }
+
+    return true;
+}
+
+void EventLoop::stop() {
+    if (!running_) return;
+
+    running_ = false;
+    wakeup();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    close_all_connections();
+    std::cout << "事件循环 " << id_ << " 连接池: 新建 " << connection_pool_->created_count()
+              << " 个连接对象，复用 " << connection_pool_->reused_count() << " 次" << std::endl;
+}
+
+void EventLoop::post(std::function<void()> functor) {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending_functors_.push_back(std::move(functor));
+    }
+    wakeup();
+}
+
+void EventLoop::run_pending_functors() {
+    std::vector<std::function<void()>> functors;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        functors.swap(pending_functors_);
+    }
+
+    for (auto& functor : functors) {
+        functor();
+    }
+}
+
+void EventLoop::complete_request(std::shared_ptr<Connection> conn, ResponseBuffer response_data) {
+    post([this, conn, data = std::move(response_data)]() mutable {
+        if (!conn->is_active()) return;
+        send_response(conn, std::move(data));
+    });
+}
+
+void EventLoop::defer_write(const std::shared_ptr<Connection>& conn) {
+    if (conn->is_send_throttled()) {
+        deferred_writes_.push_back(conn);
+    }
+}
+
+void EventLoop::resume_deferred_writes() {
+    if (deferred_writes_.empty()) return;
+    
+    std::vector<std::weak_ptr<Connection>> pending;
+    pending.swap(deferred_writes_);
+    for (auto& weak : pending) {
+        std::shared_ptr<Connection> conn = weak.lock();
+        // 同一连接可能被登记多次，已恢复发送的跳过
+        if (conn && conn->is_send_throttled() && conn->get_state() == ConnectionState::WRITING) {
+            resume_write(conn);
+        }
+    }
+}
+
+std::shared_ptr<Connection> EventLoop::create_connection(socket_t client_socket, const struct sockaddr_in* peer_addr) {
+    // 检查连接数限制
+    if (active_connections_ >= max_connections_) {
+        std::cout << "达到最大连接数限制，拒绝新连接" << std::endl;
+        if (admission_) {
+            admission_->reject_connection(client_socket);
+        } else {
+            ::close(client_socket);
+        }
+        return nullptr;
+    }
+
+    // 获取客户端IP地址（调用方未提供时查询对端地址）
+    struct sockaddr_in client_addr;
+    socklen_t client_len = sizeof(client_addr);
+    char client_ip[INET_ADDRSTRLEN] = "0.0.0.0";
+    if (peer_addr) {
+        inet_ntop(AF_INET, &peer_addr->sin_addr, client_ip, INET_ADDRSTRLEN);
+    } else if (getpeername(client_socket, (struct sockaddr*)&client_addr, &client_len) == 0) {
+        inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, INET_ADDRSTRLEN);
+    }
+
+    auto connection = connection_pool_->acquire(client_socket, client_ip);
+    connection->set_admission_controller(admission_);
+    connection->set_dispatcher([this](std::shared_ptr<Connection> conn) {
+        handle_request(std::move(conn));
+    });
+    if (disk_handler_) {
+        connection->set_body_task_runner([this](std::shared_ptr<Connection> conn, std::function<void()> work) {
+            return run_body_task(std::move(conn), std::move(work));
+        });
+    }
+
+    timer_wheel_.schedule(connection);
+    active_connections_++;
+    std::cout << "事件循环 " << id_ << " 接受来自 " << client_ip
+              << " 的连接 (活跃连接: " << active_connections_ << ")" << std::endl;
+    return connection;
+}
+
+void EventLoop::handle_request(std::shared_ptr<Connection> conn) {
+    total_requests_++;
+
+    if (request_handler_ && request_handler_(*this, conn)) {
+        return;
+    }
+
+    // 不经过工作线程时在事件循环线程内联处理，连接从头到尾都属于本线程
+    send_response(conn, conn->process_request());
+}
+
+bool EventLoop::run_body_task(std::shared_ptr<Connection> conn, std::function<void()> work) {
+    return disk_handler_(conn, [this, conn, work = std::move(work)]() {
+        work();
+        post([this, conn]() {
+            if (!conn->is_active()) return;
+            conn->on_body_task_done();
+            resume_read(conn);
+        });
+    });
+}
+
+// EpollEventLoop 实现
+EpollEventLoop::EpollEventLoop(size_t id, socket_t listen_socket, size_t max_connections)
+    : EventLoop(id, listen_socket, max_connections), epoll_handle_(-1), wakeup_fd_(-1) {
+    last_cleanup_ = std::chrono::steady_clock::now();
+}
+
+EpollEventLoop::~EpollEventLoop() {
+    stop();
+
+    if (wakeup_fd_ != -1) {
+        ::close(wakeup_fd_);
+    }
+    if (epoll_handle_ != -1) {
+        ::close(epoll_handle_);
+    }
+}
+
+bool EpollEventLoop::setup() {
+    epoll_handle_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_handle_ == -1) {
+        std::cerr << "创建epoll失败" << std::endl;
+        return false;
+    }
+
+    // 边缘触发下监听socket必须是非阻塞的，accept循环才能以EAGAIN结束
+    int flags = fcntl(listen_socket_, F_GETFL, 0);
+    fcntl(listen_socket_, F_SETFL, flags | O_NONBLOCK);
+
+    // 将监听socket添加到epoll
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLET;
+    event.data.u64 = LISTEN_TOKEN;
+
+    if (epoll_ctl(epoll_handle_, EPOLL_CTL_ADD, listen_socket_, &event) == -1) {
+        std::cerr << "添加服务器socket到epoll失败" << std::endl;
+        return false;
+    }
+
+    // 其他线程通过eventfd唤醒事件循环
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ == -1) {
+        std::cerr << "创建eventfd失败" << std::endl;
+        return false;
+    }
+
+    event.events = EPOLLIN | EPOLLET;
+    event.data.u64 = WAKEUP_TOKEN;
+    if (epoll_ctl(epoll_handle_, EPOLL_CTL_ADD, wakeup_fd_, &event) == -1) {
+        std::cerr << "添加eventfd到epoll失败" << std::endl;
+        return false;
+    }
+
+    epoll_events_.resize(PerformanceConfig::EPOLL_MAX_EVENTS);  // 预分配事件数组
+    return true;
+}
+
+void EpollEventLoop::run() {
+    std::cout << "事件循环 " << id_ << " 启动..." << std::endl;
+
+    while (running_) {
+        int num_events = epoll_wait(epoll_handle_, epoll_events_.data(),
+                                   static_cast<int>(epoll_events_.size()),
+                                   static_cast<int>(PerformanceConfig::EPOLL_TIMEOUT_MS));
+
+        if (num_events < 0 && errno != EINTR) {
+            std::cerr << "epoll等待失败，错误码: " << errno << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < num_events; ++i) {
+            uint64_t token = epoll_events_[i].data.u64;
+            uint32_t events = epoll_events_[i].events;
+
+            if (token == LISTEN_TOKEN) {
+                // 监听socket可读：有新连接
+                accept_connections();
+            } else if (token == WAKEUP_TOKEN) {
+                // 其他线程投递了待执行的回调
+                uint64_t counter;
+                while (read(wakeup_fd_, &counter, sizeof(counter)) > 0) {}
+                run_pending_functors();
+            } else {
+                handle_connection_event(token, events);
+            }
+        }
+
+        // 每个时间轮tick推进一次，只检查到期槽位中的连接
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_cleanup_ >= std::chrono::milliseconds(PerformanceConfig::TIMER_WHEEL_TICK_MS)) {
+            cleanup_expired_connections();
+            resume_deferred_writes();
+            last_cleanup_ = now;
+        }
+    }
+
+    std::cout << "事件循环 " << id_ << " 退出" << std::endl;
+}
+
+void EpollEventLoop::accept_connections() {
+    // 边缘触发：一次可读事件可能对应多个排队的连接，必须循环accept直到EAGAIN
+    while (running_) {
+        struct sockaddr_in client_addr;
+        socklen_t client_len = sizeof(client_addr);
+
+        socket_t client_socket = accept4(listen_socket_, (struct sockaddr*)&client_addr, &client_len,
+                                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_socket == INVALID_SOCKET) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "接受连接失败，错误码: " << errno << std::endl;
+            }
+            break;
+        }
+
+        auto connection = create_connection(client_socket, &client_addr);
+        if (!connection) {
+            continue;
+        }
+
+        ConnectionHandle handle = connections_.insert(client_socket, connection);
+        if (handle == INVALID_CONNECTION_HANDLE) {
+            std::cerr << "连接表中fd " << client_socket << " 仍被占用" << std::endl;
+            connection->close();
+            active_connections_--;
+            continue;
+        }
+        connection->set_handle(handle);
+
+        // 注册为边缘触发，读写事件一次注册，后续无需EPOLL_CTL_MOD
+        struct epoll_event event;
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.u64 = handle;
+        if (epoll_ctl(epoll_handle_, EPOLL_CTL_ADD, client_socket, &event) == -1) {
+            std::cerr << "添加客户端socket到epoll失败，错误码: " << errno << std::endl;
+            close_connection(connection);
+            continue;
+        }
+
+        connection->async_read();
+    }
+}
+
+void EpollEventLoop::handle_connection_event(ConnectionHandle handle, uint32_t events) {
+    // 同一批事件中连接可能已被关闭，fd甚至已被新连接复用，过期句柄直接忽略
+    std::shared_ptr<Connection> guard = connections_.get(handle);
+    if (!guard) return;
+    Connection* conn = guard.get();
+
+    if (events & EPOLLERR) {
+        close_connection(guard);
+        return;
+    }
+
+    // 处理读取事件：正在处理中的连接暂不读取，数据留在内核缓冲区
+    if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+        ConnectionState state = conn->get_state();
+        if (state == ConnectionState::CONNECTING || state == ConnectionState::READING) {
+            conn->async_read();
+        } else if (events & EPOLLHUP) {
+            conn->async_close();
+        }
+    }
+
+    // 处理写入事件：继续发送上次因EAGAIN中断的数据
+    if ((events & EPOLLOUT) && conn->get_state() == ConnectionState::WRITING) {
+        conn->continue_write();
+        defer_write(guard);
+        resume_reading(guard);
+    }
+
+    close_if_finished(guard);
+}
+
+void EpollEventLoop::send_response(const std::shared_ptr<Connection>& conn, ResponseBuffer response_data) {
+    conn->async_write(std::move(response_data));
+    defer_write(conn);
+    resume_reading(conn);
+    close_if_finished(conn);
+}
+
+void EpollEventLoop::resume_write(const std::shared_ptr<Connection>& conn) {
+    conn->continue_write();
+    defer_write(conn);
+    resume_reading(conn);
+    close_if_finished(conn);
+}
+
+void EpollEventLoop::resume_read(const std::shared_ptr<Connection>& conn) {
+    resume_reading(conn);
+    close_if_finished(conn);
+}
+
+void EpollEventLoop::resume_reading(const std::shared_ptr<Connection>& conn) {
+    // 持久连接的响应发完后回到读取状态；处理期间到达的数据不会再触发边缘事件，需主动读取
+    if (conn->get_state() == ConnectionState::READING) {
+        conn->async_read();
+    }
+}
+
+void EpollEventLoop::close_if_finished(const std::shared_ptr<Connection>& conn) {
+    ConnectionState state = conn->get_state();
+    if (state == ConnectionState::CLOSING || state == ConnectionState::CLOSED) {
+        close_connection(conn);
+    }
+}
+
+void EpollEventLoop::close_connection(const std::shared_ptr<Connection>& conn) {
+    if (conn->get_socket() != INVALID_SOCKET) {
+        epoll_ctl(epoll_handle_, EPOLL_CTL_DEL, conn->get_socket(), nullptr);
+        conn->close();
+    }
+
+    if (connections_.erase(conn->get_handle())) {
+        active_connections_--;
+    }
+}
+
+void EpollEventLoop::wakeup() {
+    uint64_t one = 1;
+    if (write(wakeup_fd_, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        std::cerr << "唤醒事件循环失败，错误码: " << errno << std::endl;
+    }
+}
+
+void EpollEventLoop::cleanup_expired_connections() {
+    timer_wheel_.advance(std::chrono::steady_clock::now(), [this](const std::shared_ptr<Connection>& conn) {
+        if (!conn->is_active()) return;
+        std::cout << "清理过期连接: " << conn->get_client_ip() << std::endl;
+        close_connection(conn);
+    });
+}
+
+void EpollEventLoop::close_all_connections() {
+    connections_.for_each([](const std::shared_ptr<Connection>& conn) {
+        conn->close();
+    });
+    active_connections_ -= connections_.size();
+    connections_.clear();
+    timer_wheel_.clear();
+}
+
+#endif // !_WIN32
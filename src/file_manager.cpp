@@ -7,11 +7,103 @@
 #include <cctype>
 #include <chrono>
 #include <ctime>
+#include <atomic>
+#include <climits>
 
 #ifdef _WIN32
 #include <windows.h>
 #include <sys/stat.h>
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+FileBody::FileBody(int fd, uint64_t size, int64_t modified_time, uint32_t modified_nsec, uint64_t inode)
+    : fd_(fd), size_(size), modified_time_(modified_time), modified_nsec_(modified_nsec), inode_(inode) {}
+
+FileBody::~FileBody() {
+#ifdef _WIN32
+    _close(fd_);
+#else
+    ::close(fd_);
+#endif
+}
+
+long long FileBody::read(uint64_t position, char* buffer, size_t length) const {
+#ifdef _WIN32
+    // CRT文件描述符没有pread，同一文件只由一个连接顺序读取
+    if (_lseeki64(fd_, static_cast<__int64>(position), SEEK_SET) < 0) {
+        return -1;
+    }
+    return _read(fd_, buffer, static_cast<unsigned int>(length));
+#else
+    return ::pread(fd_, buffer, length, static_cast<off_t>(position));
+#endif
+}
+
+FileWriter::FileWriter(int fd, std::filesystem::path temp_path, std::filesystem::path final_path)
+    : fd_(fd), size_(0), committed_(false),
+      temp_path_(std::move(temp_path)), final_path_(std::move(final_path)) {}
+
+FileWriter::~FileWriter() {
+    if (fd_ >= 0) {
+#ifdef _WIN32
+        _close(fd_);
+#else
+        ::close(fd_);
 #endif
+    }
+    if (!committed_) {
+        std::error_code ec;
+        std::filesystem::remove(temp_path_, ec);
+    }
+}
+
+bool FileWriter::write(const char* data, size_t length) {
+    while (length > 0) {
+#ifdef _WIN32
+        int written = _write(fd_, data, static_cast<unsigned int>((std::min)(length, static_cast<size_t>(INT_MAX))));
+#else
+        ssize_t written = ::write(fd_, data, length);
+        if (written < 0 && errno == EINTR) continue;
+#endif
+        if (written <= 0) {
+            std::cerr << "写入文件失败: " << temp_path_.string() << std::endl;
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+        size_ += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+bool FileWriter::commit() {
+#ifdef _WIN32
+    int result = _close(fd_);
+#else
+    int result = ::close(fd_);
+#endif
+    fd_ = -1;
+    if (result != 0) {
+        std::cerr << "关闭文件失败: " << temp_path_.string() << std::endl;
+        return false;
+    }
+    
+    std::error_code ec;
+    std::filesystem::rename(temp_path_, final_path_, ec);
+    if (ec) {
+        std::cerr << "重命名上传文件失败: " << final_path_.string() << " (" << ec.message() << ")" << std::endl;
+        return false;
+    }
+    committed_ = true;
+    std::cout << "文件保存成功: " << final_path_.filename().string() << " (大小: " << size_ << " 字节)" << std::endl;
+    return true;
+}
 
 FileManager::FileManager(const std::string& upload_dir) 
     : upload_dir_(upload_dir), upload_path_(upload_dir) {
@@ -158,6 +250,78 @@ std::vector<char> FileManager::read_file(const std::string& filename) {
     return content;
 }
 
+std::shared_ptr<FileBody> FileManager::open_file(const std::string& filename) {
+    if (!is_valid_filename(filename)) {
+        std::cerr << "无效的文件名: " << filename << std::endl;
+        return nullptr;
+    }
+    
+    std::string sanitized_name = sanitize_filename(filename);
+    std::filesystem::path file_path = upload_path_ / sanitized_name;
+    
+#ifdef _WIN32
+    int fd = _wopen(file_path.wstring().c_str(), _O_RDONLY | _O_BINARY);
+    if (fd < 0) {
+        std::cerr << "无法打开文件: " << file_path.string() << std::endl;
+        return nullptr;
+    }
+    struct _stat64 info;
+    if (_fstat64(fd, &info) != 0 || (info.st_mode & _S_IFREG) == 0) {
+        _close(fd);
+        std::cerr << "不是普通文件: " << file_path.string() << std::endl;
+        return nullptr;
+    }
+    // NTFS下_fstat64不提供文件编号和亚秒时间
+    uint32_t modified_nsec = 0;
+    uint64_t inode = 0;
+#else
+    int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "无法打开文件: " << file_path.string() << std::endl;
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        std::cerr << "不是普通文件: " << file_path.string() << std::endl;
+        return nullptr;
+    }
+    uint32_t modified_nsec = static_cast<uint32_t>(info.st_mtim.tv_nsec);
+    uint64_t inode = static_cast<uint64_t>(info.st_ino);
+#endif
+    
+    std::cout << "文件打开成功: " << sanitized_name << " (大小: " << info.st_size << " 字节)" << std::endl;
+    return std::make_shared<FileBody>(fd, static_cast<uint64_t>(info.st_size),
+                                      static_cast<int64_t>(info.st_mtime), modified_nsec, inode);
+}
+
+std::unique_ptr<FileWriter> FileManager::create_file(const std::string& filename) {
+    if (!is_valid_filename(filename)) {
+        std::cerr << "无效的文件名: " << filename << std::endl;
+        return nullptr;
+    }
+    
+    std::string sanitized_name = sanitize_filename(filename);
+    std::filesystem::path final_path = upload_path_ / sanitized_name;
+    
+    // 临时文件以点开头（合法文件名不会以点开头），文件列表不显示；序号保证并发上传同名文件时互不干扰
+    static std::atomic<uint64_t> upload_counter{0};
+    std::filesystem::path temp_path = upload_path_ /
+        ("." + sanitized_name + "." + std::to_string(upload_counter.fetch_add(1)) + ".uploading");
+    
+#ifdef _WIN32
+    int fd = _wopen(temp_path.wstring().c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+    if (fd < 0) {
+        std::cerr << "无法创建文件: " << temp_path.string() << std::endl;
+        return nullptr;
+    }
+    
+    return std::make_unique<FileWriter>(fd, temp_path, final_path);
+}
+
 bool FileManager::file_exists(const std::string& filename) {
     // 首先检查文件名是否有效
     if (!is_valid_filename(filename)) {
@@ -351,6 +515,11 @@ std::vector<FileInfo> FileManager::list_files() {
                 // 获取文件名，确保编码一致性
                 std::string filename = entry.path().filename().string();
                 
+                // 以点开头的是正在上传的临时文件
+                if (!filename.empty() && filename.front() == '.') {
+                    continue;
+                }
+                
                 // 输出详细的调试信息
                 std::cout << "发现文件: " << filename << std::endl;
                 std::cout << "文件名长度: " << filename.length() << std::endl;
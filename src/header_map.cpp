@@ -0,0 +1,130 @@
+#include "../include/header_map.h"
+
+namespace {
+    // 常用头部的规范写法，顺序与HeaderId一致
+    const std::string_view KNOWN_NAMES[] = {
+        "Content-Length",
+        "Content-Type",
+        "Content-Range",
+        "Content-Disposition",
+        "Connection",
+        "Keep-Alive",
+        "Host",
+        "Expect",
+        "Range",
+        "If-Range",
+        "If-None-Match",
+        "If-Modified-Since",
+        "ETag",
+        "Last-Modified",
+        "Accept-Ranges",
+        "Retry-After",
+        "Transfer-Encoding",
+    };
+
+    static_assert(sizeof(KNOWN_NAMES) / sizeof(KNOWN_NAMES[0]) == static_cast<size_t>(HeaderId::OTHER),
+                  "KNOWN_NAMES必须与HeaderId一一对应");
+
+    // 大多数请求和响应的头部数不超过此值，首次加入时一次预留
+    constexpr size_t INITIAL_CAPACITY = 16;
+
+    char to_lower(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+}
+
+HeaderMap::HeaderMap() {
+    for (uint16_t& position : positions_) {
+        position = NOT_PRESENT;
+    }
+}
+
+HeaderId HeaderMap::lookup(std::string_view name) {
+    for (size_t i = 0; i < KNOWN_COUNT; ++i) {
+        if (equals_ignore_case(name, KNOWN_NAMES[i])) {
+            return static_cast<HeaderId>(i);
+        }
+    }
+    return HeaderId::OTHER;
+}
+
+bool HeaderMap::equals_ignore_case(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (to_lower(a[i]) != to_lower(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::string* HeaderMap::get(HeaderId id) const {
+    if (id == HeaderId::OTHER) {
+        return nullptr;
+    }
+    uint16_t position = positions_[static_cast<size_t>(id)];
+    return position == NOT_PRESENT ? nullptr : &headers_[position].value;
+}
+
+const std::string* HeaderMap::get(std::string_view name) const {
+    HeaderId id = lookup(name);
+    if (id != HeaderId::OTHER) {
+        return get(id);
+    }
+    for (const Header& header : headers_) {
+        if (header.id == HeaderId::OTHER && equals_ignore_case(header.name, name)) {
+            return &header.value;
+        }
+    }
+    return nullptr;
+}
+
+HeaderMap::Header* HeaderMap::find(HeaderId id, std::string_view name) {
+    if (id != HeaderId::OTHER) {
+        uint16_t position = positions_[static_cast<size_t>(id)];
+        return position == NOT_PRESENT ? nullptr : &headers_[position];
+    }
+    for (Header& header : headers_) {
+        if (header.id == HeaderId::OTHER && equals_ignore_case(header.name, name)) {
+            return &header;
+        }
+    }
+    return nullptr;
+}
+
+void HeaderMap::set(std::string_view name, std::string value) {
+    (*this)[name] = std::move(value);
+}
+
+bool HeaderMap::insert(std::string_view name, std::string value) {
+    if (find(lookup(name), name)) {
+        return false;
+    }
+    (*this)[name] = std::move(value);
+    return true;
+}
+
+std::string& HeaderMap::operator[](std::string_view name) {
+    HeaderId id = lookup(name);
+    if (Header* header = find(id, name)) {
+        return header->value;
+    }
+
+    if (headers_.empty()) {
+        headers_.reserve(INITIAL_CAPACITY);
+    }
+    if (id != HeaderId::OTHER) {
+        positions_[static_cast<size_t>(id)] = static_cast<uint16_t>(headers_.size());
+    }
+    headers_.push_back(Header{id, std::string(name), std::string()});
+    return headers_.back().value;
+}
+
+void HeaderMap::clear() {
+    headers_.clear();
+    for (uint16_t& position : positions_) {
+        position = NOT_PRESENT;
+    }
+}
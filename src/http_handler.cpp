@@ -1,102 +1,143 @@
 ﻿#include "../include/http_handler.h"
 #include "../include/file_manager.h"
+#include "../include/upload_sink.h"
+#include "../include/request_parser.h"
+#include "../include/router.h"
+#include "../include/performance_config.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
 #include <cctype>
 #include <iomanip>
 #include <codecvt>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <ctime>
+
+namespace {
+    struct RouteEntry {
+        HttpMethod method;
+        const char* pattern;
+        Endpoint endpoint;
+        HttpHandler::Handler handler;
+    };
+    
+    // 全部端点在这里注册，路由表中的编号即此数组的下标；
+    // 文件名可能含编码后的任意字符，用"{name*}"匹配剩余的全部路径。
+    // /stats是内容固定的小响应，由调用方直接写出，不经过HttpResponse，没有处理函数
+    const RouteEntry ROUTES[] = {
+        {HttpMethod::HTTP_GET, "/files", Endpoint::LIST_FILES, &HttpHandler::handle_list_files},
+        {HttpMethod::HTTP_GET, "/download/{name*}", Endpoint::DOWNLOAD_FILE, &HttpHandler::handle_download},
+        {HttpMethod::HTTP_GET, "/stats", Endpoint::STATS, nullptr},
+        {HttpMethod::HTTP_POST, "/upload", Endpoint::UPLOAD, &HttpHandler::handle_upload},
+        {HttpMethod::HTTP_PUT, "/files/{name*}", Endpoint::PUT_FILE, &HttpHandler::handle_put_file},
+        {HttpMethod::HTTP_DELETE, "/delete/{name*}", Endpoint::DELETE_FILE, &HttpHandler::handle_delete_file},
+    };
+    
+    // 首次使用时建立，之后只读
+    const Router& route_table() {
+        static const Router router = [] {
+            Router table;
+            for (size_t i = 0; i < sizeof(ROUTES) / sizeof(ROUTES[0]); ++i) {
+                table.add(ROUTES[i].method, ROUTES[i].pattern, static_cast<int>(i));
+            }
+            return table;
+        }();
+        return router;
+    }
+}
 
 HttpHandler::HttpHandler() {}
 
-HttpRequest HttpHandler::parse_request(const std::string& raw_request) {
-    HttpRequest request;
-    
-    std::cout << "原始请求数据长度: " << raw_request.length() << std::endl;
-    std::cout << "原始请求前200字符: " << raw_request.substr(0, 200) << std::endl;
-    
-    // 查找请求行和头部的分界线
-    size_t header_end = raw_request.find("\r\n\r\n");
-    if (header_end == std::string::npos) {
-        header_end = raw_request.find("\n\n");
+HttpHandler::Route HttpHandler::route(std::string_view method, std::string_view path) {
+    Route result{Endpoint::METHOD_NOT_ALLOWED, nullptr, std::string()};
+    HttpMethod http_method = parse_method(method);
+    if (http_method == HttpMethod::HTTP_OTHER) {
+        return result;
     }
     
-    std::cout << "头部结束位置: " << header_end << std::endl;
-    
-    std::string headers_text = raw_request.substr(0, header_end);
-    if (header_end != std::string::npos && header_end + 4 < raw_request.length()) {
-        request.body = raw_request.substr(header_end + 4);
+    Router::Match match;
+    if (!route_table().match(http_method, path, match)) {
+        result.endpoint = Endpoint::NOT_FOUND;
+        return result;
+    }
+    const RouteEntry& entry = ROUTES[match.target];
+    result.endpoint = entry.endpoint;
+    result.handler = entry.handler;
+    if (match.param_count > 0) {
+        result.name.assign(match.params[0].data(), match.params[0].size());
     }
+    return result;
+}
+
+HttpRequest HttpHandler::parse_request(const std::string& raw_request) {
+    RequestParser parser;
+    parser.parse(raw_request);
+    return make_request(parser, raw_request);
+}
+
+HttpRequest HttpHandler::make_request(const RequestParser& parser, std::string_view raw_request) {
+    HttpRequest request;
+    request.method = parser.method();
+    request.path = parser.path();
+    request.version = parser.version();
     
-    // 解析请求行
-    std::istringstream header_stream(headers_text);
-    std::string line;
-    if (std::getline(header_stream, line)) {
-        std::istringstream line_stream(line);
-        line_stream >> request.method >> request.path >> request.version;
-        std::cout << "解析结果 - 方法: '" << request.method << "', 路径: '" << request.path << "', 版本: '" << request.version << "'" << std::endl;
+    // 头部不完整时只取已解析的字段，不取body；重复字段取第一个，与连接检查头部时看到的值一致
+    for (size_t i = 0; i < parser.header_count(); ++i) {
+        request.headers.insert(parser.header_name(i), std::string(parser.header_value(i)));
     }
     
-    // 解析头部
-    while (std::getline(header_stream, line) && !line.empty() && line != "\r") {
-        if (line.back() == '\r') line.pop_back();
-        if (line.empty()) continue;
-        
-        auto header_pair = parse_header_line(line);
-        if (!header_pair.first.empty()) {
-            request.headers[header_pair.first] = header_pair.second;
-            std::cout << "请求头: " << header_pair.first << ": " << header_pair.second << std::endl;
-        }
+    size_t header_length = parser.header_length();
+    if (header_length > 0 && header_length < raw_request.size()) {
+        request.body = raw_request.substr(header_length);
     }
     
     return request;
 }
 
 std::string HttpHandler::build_response(const HttpResponse& response) {
-    std::ostringstream oss;
-    
-    // 状态行
-    oss << "HTTP/1.1 " << response.status_code << " " << response.status_text << "\r\n";
-    
-    // 添加必要的HTTP头
-    oss << "Content-Length: " << response.body.length() << "\r\n";
-    oss << "Connection: close\r\n";
-    
-    // 安全地获取Content-Type，如果不存在则使用默认值
-    auto content_type_it = response.headers.find("Content-Type");
-    std::string content_type = (content_type_it != response.headers.end()) ? 
-                               content_type_it->second : "text/plain; charset=utf-8";
-    
-    // 确保Content-Type包含字符集信息
-    if (content_type.find("charset=") == std::string::npos) {
-        content_type += "; charset=utf-8";
-    }
-    
-    oss << "Content-Type: " << content_type << "\r\n";
-    
-    // 添加所有其他自定义HTTP头
-    for (const auto& header : response.headers) {
-        if (header.first != "Content-Type" && header.first != "Content-Length") {
-            oss << header.first << ": " << header.second << "\r\n";
-        }
+    ResponseHead head;
+    ResponseWriter::write_head(response, head);
+    return head.str() + response.body;
+}
+
+ResponseBuffer HttpHandler::build_response(HttpResponse&& response) {
+    ResponseBuffer buffer;
+    ResponseWriter::write_head(response, buffer.head);
+    buffer.body = std::move(response.body);
+    buffer.file = std::move(response.file);
+    buffer.file_ranges = std::move(response.file_ranges);
+    buffer.trailer = std::move(response.trailer);
+    return buffer;
+}
+
+// 文件区间只有在带文件时才计入
+static uint64_t file_ranges_length(const std::shared_ptr<FileBody>& file, const std::vector<FileRange>& ranges) {
+    uint64_t length = 0;
+    for (const FileRange& range : ranges) {
+        length += range.prefix.size() + (file ? range.length : 0);
     }
-    
-    // 空行
-    oss << "\r\n";
-    
-    // 响应体
-    oss << response.body;
-    
-    return oss.str();
+    return length;
+}
+
+uint64_t HttpResponse::content_length() const {
+    return body.size() + file_ranges_length(file, file_ranges) + trailer.size();
+}
+
+uint64_t ResponseBuffer::size() const {
+    return head.size() + body.size() + file_ranges_length(file, file_ranges) + trailer.size();
 }
 
 HttpResponse HttpHandler::handle_upload(const HttpRequest& request) {
     HttpResponse response;
     
     // 修复：安全地访问 Content-Length
-    auto content_length_it = request.headers.find("Content-Length");
-    if (content_length_it != request.headers.end()) {
-        std::cout << "Content-Length: " << content_length_it->second << std::endl;
+    const std::string* content_length = request.headers.get(HeaderId::CONTENT_LENGTH);
+    if (content_length) {
+        std::cout << "Content-Length: " << *content_length << std::endl;
     }
     else {
         std::cout << "Content-Length: 未找到" << std::endl;
@@ -105,9 +146,8 @@ HttpResponse HttpHandler::handle_upload(const HttpRequest& request) {
     std::cout << "实际接收到的body长度: " << request.body.length() << std::endl;
 
     // 检查Content-Type是否为multipart/form-data
-    auto content_type_it = request.headers.find("Content-Type");
-    if (content_type_it == request.headers.end() || 
-        content_type_it->second.find("multipart/form-data") == std::string::npos) {
+    const std::string* content_type = request.headers.get(HeaderId::CONTENT_TYPE);
+    if (!content_type || content_type->find("multipart/form-data") == std::string::npos) {
         response.status_code = 400;
         response.status_text = "Bad Request";
         response.body = "Content-Type必须是multipart/form-data";
@@ -115,15 +155,7 @@ HttpResponse HttpHandler::handle_upload(const HttpRequest& request) {
         return response;
     }
     
-    // 解析multipart数据
-    std::string boundary;
-    size_t boundary_pos = content_type_it->second.find("boundary=");
-    if (boundary_pos != std::string::npos) {
-        boundary = content_type_it->second.substr(boundary_pos + 9);
-        if (boundary.front() == '"') boundary = boundary.substr(1);
-        if (boundary.back() == '"') boundary.pop_back();
-    }
-    
+    std::string boundary = parse_boundary(*content_type);
     if (boundary.empty()) {
         response.status_code = 400;
         response.status_text = "Bad Request";
@@ -132,30 +164,123 @@ HttpResponse HttpHandler::handle_upload(const HttpRequest& request) {
         return response;
     }
     
-    // 存储所有文件信息
-    std::vector<std::pair<std::string, std::string>> files_to_save;
-    std::vector<std::string> saved_files;
-    std::vector<std::string> failed_files;
-    
-    size_t pos = request.body.find("--" + boundary);
-    while (pos != std::string::npos) {
-        size_t next_boundary = request.body.find("--" + boundary, pos + boundary.length() + 2);
-        if (next_boundary == std::string::npos) break;
+    // 已完整读入内存的body（没有Content-Length等无法流式接收的请求）同样交给增量解析器
+    MultipartUploadSink sink(boundary);
+    sink.write(request.body.data(), request.body.size());
+    return sink.finish();
+}
 
-        std::string part = request.body.substr(pos, next_boundary - pos);
-        std::string filename = utf8_to_acp(parse_filename(part));
-        
-        // 查找文件数据开始位置
-        size_t data_start = part.find("\r\n\r\n");
-        if (data_start != std::string::npos && !filename.empty()) {
-            std::string file_data = part.substr(data_start + 4);
-            files_to_save.push_back({filename, file_data});
+long long BodySink::receive_from(int socket, uint64_t max_length) {
+    (void)socket;
+    (void)max_length;
+    errno = ENOSYS;
+    return -1;
+}
+
+bool BodySink::write_received(uint64_t length) {
+    return length == 0;
+}
+
+std::unique_ptr<BodySink> HttpHandler::create_body_sink(Endpoint endpoint, const HttpRequest& request) {
+    if (endpoint == Endpoint::PUT_FILE) {
+        std::string filename = put_filename(request.name);
+        const std::string* content_length_value = request.headers.get(HeaderId::CONTENT_LENGTH);
+        if (filename.empty() || !content_length_value) {
+            return nullptr;
         }
         
-        pos = next_boundary;
+        FileManager file_manager;
+        bool replacing = file_manager.file_exists(filename);
+        std::unique_ptr<FileWriter> writer = file_manager.create_file(filename);
+        if (!writer) {
+            return nullptr;
+        }
+        uint64_t content_length = std::strtoull(content_length_value->c_str(), nullptr, 10);
+        return std::make_unique<RawUploadSink>(filename, std::move(writer), content_length, replacing);
+    }
+    
+    if (endpoint != Endpoint::UPLOAD) {
+        return nullptr;
+    }
+    
+    const std::string* content_type = request.headers.get(HeaderId::CONTENT_TYPE);
+    if (!content_type || content_type->find("multipart/form-data") == std::string::npos) {
+        return nullptr;
     }
     
-    if (files_to_save.empty()) {
+    std::string boundary = parse_boundary(*content_type);
+    if (boundary.empty()) {
+        return nullptr;
+    }
+    return std::make_unique<MultipartUploadSink>(boundary);
+}
+
+HttpResponse HttpHandler::handle_put_file(const HttpRequest& request) {
+    HttpResponse response;
+    response.headers["Content-Type"] = "text/plain; charset=utf-8";
+    
+    // 已完整读入内存的body（Windows同步服务器等不流式接收的路径）同样交给RawUploadSink，
+    // 写入临时文件后替换，结果与流式接收一致
+    std::unique_ptr<BodySink> sink = create_body_sink(Endpoint::PUT_FILE, request);
+    if (sink) {
+        sink->write(request.body.data(), request.body.size());
+        return sink->finish();
+    }
+    
+    std::string filename = put_filename(request.name);
+    if (filename.empty()) {
+        response.status_code = 400;
+        response.status_text = "Bad Request";
+        response.body = "无效的文件名";
+    } else if (!request.headers.contains(HeaderId::CONTENT_LENGTH)) {
+        response.status_code = 411;
+        response.status_text = "Length Required";
+        response.body = "PUT上传需要Content-Length";
+    } else {
+        response.status_code = 500;
+        response.status_text = "Internal Server Error";
+        response.body = "无法创建文件: " + filename;
+    }
+    return response;
+}
+
+std::string HttpHandler::put_filename(std::string_view name) {
+    std::string filename;
+    try {
+        filename = utf8_to_acp(url_decode(std::string(name)));
+    } catch (const std::exception& e) {
+        std::cerr << "URL解码异常: " << e.what() << std::endl;
+        return "";
+    }
+    return FileManager::is_valid_filename(filename) ? filename : "";
+}
+
+std::string HttpHandler::parse_boundary(const std::string& content_type) {
+    size_t boundary_pos = content_type.find("boundary=");
+    if (boundary_pos == std::string::npos) {
+        return "";
+    }
+    
+    std::string boundary = content_type.substr(boundary_pos + 9);
+    size_t param_end = boundary.find(';');
+    if (param_end != std::string::npos) {
+        boundary.erase(param_end);
+    }
+    boundary.erase(boundary.find_last_not_of(" \t") + 1);
+    if (!boundary.empty() && boundary.front() == '"') boundary.erase(0, 1);
+    if (!boundary.empty() && boundary.back() == '"') boundary.pop_back();
+    return boundary;
+}
+
+std::string HttpHandler::part_filename(const std::string& part_headers) {
+    return utf8_to_acp(parse_filename(part_headers));
+}
+
+HttpResponse HttpHandler::build_upload_response(const std::vector<std::string>& saved_files,
+                                                const std::vector<std::string>& failed_files) {
+    HttpResponse response;
+    
+    if (saved_files.empty() && failed_files.empty()) {
         response.status_code = 400;
         response.status_text = "Bad Request";
         response.body = "未找到文件数据";
@@ -163,19 +288,6 @@ HttpResponse HttpHandler::handle_upload(const HttpRequest& request) {
         return response;
     }
     
-    // 保存所有文件
-    FileManager file_manager;
-    for (const auto& file_info : files_to_save) {
-        const std::string& filename = file_info.first;
-        const std::string& file_data = file_info.second;
-        
-        if (file_manager.save_file(filename, file_data)) {
-            saved_files.push_back(filename);
-        } else {
-            failed_files.push_back(filename);
-        }
-    }
-    
     // 构建响应消息
     std::ostringstream response_body;
     if (!saved_files.empty()) {
@@ -215,17 +327,8 @@ HttpResponse HttpHandler::handle_upload(const HttpRequest& request) {
 HttpResponse HttpHandler::handle_download(const HttpRequest& request) {
     HttpResponse response;
     
-    // 检查请求路径是否有效
-    if (request.path.length() < 11) {  // "/download/" 长度为10
-        response.status_code = 400;
-        response.status_text = "Bad Request";
-        response.body = "无效的下载路径";
-        response.headers["Content-Type"] = "text/plain; charset=utf-8";
-        return response;
-    }
-    
-    // 提取文件名
-    std::string filename = request.path.substr(10); // 去掉"/download/"
+    // 文件名为路由匹配出的{name}参数
+    std::string filename = request.name;
     std::string original_filename = filename;
     
     // 检查提取的文件名是否为空
@@ -334,9 +437,9 @@ HttpResponse HttpHandler::handle_download(const HttpRequest& request) {
         return response;
     }
     
-    // 读取文件
-    std::vector<char> file_content = file_manager.read_file(filename);
-    if (file_content.empty()) {
+    // 只打开文件，内容在发送时由内核直接从页缓存写入socket（sendfile），不读入内存
+    std::shared_ptr<FileBody> file = file_manager.open_file(filename);
+    if (!file) {
         response.status_code = 500;
         response.status_text = "Internal Server Error";
         response.body = "读取文件失败";
@@ -344,20 +447,89 @@ HttpResponse HttpHandler::handle_download(const HttpRequest& request) {
         return response;
     }
     
-    // 设置响应
-    response.status_code = 200;
-    response.status_text = "OK";
-    response.body = std::string(file_content.begin(), file_content.end());
-    
     // 安全地获取MIME类型
+    std::string content_type;
     try {
-        response.headers["Content-Type"] = get_mime_type(filename);
+        content_type = get_mime_type(filename);
     } catch (const std::exception& e) {
         std::cerr << "获取MIME类型异常: " << e.what() << std::endl;
-        response.headers["Content-Type"] = "application/octet-stream";
+        content_type = "application/octet-stream";
+    }
+    
+    // 强ETag由inode、大小和纳秒级修改时间组成，文件被替换或改写后必然变化
+    uint64_t file_size = file->size();
+    std::ostringstream etag_stream;
+    etag_stream << '"' << std::hex << file->inode() << '-' << file_size << '-'
+                << file->modified_time() << '.' << file->modified_nsec() << '"';
+    std::string etag = etag_stream.str();
+    std::string last_modified = format_http_date(file->modified_time());
+    response.headers["Accept-Ranges"] = "bytes";
+    response.headers["ETag"] = etag;
+    response.headers["Last-Modified"] = last_modified;
+    
+    // 客户端缓存的版本仍然有效，不发送文件内容
+    if (is_not_modified(request, etag, file->modified_time())) {
+        std::cout << "文件未修改，返回304: " << filename << std::endl;
+        response.status_code = 304;
+        response.status_text = "Not Modified";
+        return response;
+    }
+    
+    // 断点续传：If-Range与当前文件不一致时（文件已改变）忽略Range，发送整个文件
+    std::vector<FileRange> ranges;
+    bool partial = false;
+    const std::string* range = request.headers.get(HeaderId::RANGE);
+    if (range) {
+        const std::string* if_range = request.headers.get(HeaderId::IF_RANGE);
+        bool validator_matches = !if_range || *if_range == etag || *if_range == last_modified;
+        partial = validator_matches && parse_byte_ranges(*range, file_size, ranges);
+    }
+    
+    if (!partial) {
+        response.status_code = 200;
+        response.status_text = "OK";
+        response.headers["Content-Type"] = content_type;
+        response.file = file;
+        response.file_ranges.push_back(FileRange{std::string(), 0, file_size});
+    } else if (ranges.empty()) {
+        std::cout << "请求的范围无法满足: " << *range << std::endl;
+        response.status_code = 416;
+        response.status_text = "Range Not Satisfiable";
+        response.body = "请求的范围无法满足";
+        response.headers["Content-Type"] = "text/plain; charset=utf-8";
+        response.headers["Content-Range"] = "bytes */" + std::to_string(file_size);
+        return response;
+    } else if (ranges.size() == 1) {
+        const FileRange& range = ranges.front();
+        response.status_code = 206;
+        response.status_text = "Partial Content";
+        response.headers["Content-Type"] = content_type;
+        response.headers["Content-Range"] = "bytes " + std::to_string(range.offset) + "-" +
+            std::to_string(range.offset + range.length - 1) + "/" + std::to_string(file_size);
+        response.file = file;
+        response.file_ranges = std::move(ranges);
+    } else {
+        // 多个区间：multipart/byteranges，每段前缀是分隔行和该段的头部，各段内容仍从文件直接发送
+        static std::atomic<uint64_t> boundary_counter{0};
+        std::ostringstream boundary_stream;
+        boundary_stream << "FileServerByteranges" << std::hex << file_size << "x"
+                        << boundary_counter.fetch_add(1, std::memory_order_relaxed);
+        std::string boundary = boundary_stream.str();
+        
+        for (FileRange& range : ranges) {
+            range.prefix = (&range == &ranges.front() ? "--" : "\r\n--") + boundary + "\r\n" +
+                "Content-Type: " + content_type + "\r\n" +
+                "Content-Range: bytes " + std::to_string(range.offset) + "-" +
+                std::to_string(range.offset + range.length - 1) + "/" + std::to_string(file_size) + "\r\n\r\n";
+        }
+        response.status_code = 206;
+        response.status_text = "Partial Content";
+        response.headers["Content-Type"] = "multipart/byteranges; boundary=" + boundary;
+        response.file = file;
+        response.file_ranges = std::move(ranges);
+        response.trailer = "\r\n--" + boundary + "--\r\n";
     }
     
-    response.headers["Content-Length"] = std::to_string(file_content.size());
     
     // 关键修改：对文件名进行URL编码，确保Content-Disposition头正确
     // 同时添加调试信息
@@ -370,6 +542,172 @@ HttpResponse HttpHandler::handle_download(const HttpRequest& request) {
     return response;
 }
 
+// 十进制无符号整数，不允许空串、符号和溢出
+static bool parse_range_number(const std::string& text, uint64_t& value) {
+    if (text.empty()) return false;
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        uint64_t digit = static_cast<uint64_t>(c - '0');
+        if (value > (UINT64_MAX - digit) / 10) return false;
+        value = value * 10 + digit;
+    }
+    return true;
+}
+
+bool HttpHandler::parse_byte_ranges(const std::string& range_header, uint64_t file_size,
+                                    std::vector<FileRange>& ranges) {
+    ranges.clear();
+    
+    // 只支持bytes单位，其他单位或语法错误的Range按RFC 7233忽略
+    const std::string unit = "bytes=";
+    if (range_header.compare(0, unit.size(), unit) != 0) {
+        return false;
+    }
+    
+    size_t spec_count = 0;
+    size_t pos = unit.size();
+    while (pos <= range_header.size()) {
+        size_t comma = range_header.find(',', pos);
+        if (comma == std::string::npos) comma = range_header.size();
+        
+        size_t begin = range_header.find_first_not_of(" \t", pos);
+        size_t end = range_header.find_last_not_of(" \t", comma - 1);
+        pos = comma + 1;
+        if (begin == std::string::npos || begin >= comma || end < begin) {
+            continue;  // 允许空元素，例如"bytes=0-1,,5-6"
+        }
+        
+        // 区间过多时不做多段响应，防止大量重叠小区间放大发送量
+        if (++spec_count > PerformanceConfig::MAX_BYTE_RANGES) {
+            return false;
+        }
+        
+        std::string spec = range_header.substr(begin, end - begin + 1);
+        size_t dash = spec.find('-');
+        if (dash == std::string::npos) {
+            return false;
+        }
+        std::string first = spec.substr(0, dash);
+        std::string last = spec.substr(dash + 1);
+        
+        uint64_t start;
+        uint64_t stop;
+        if (first.empty()) {
+            // 后缀区间"-N"：文件最后N字节
+            uint64_t suffix;
+            if (!parse_range_number(last, suffix)) return false;
+            if (suffix == 0 || file_size == 0) continue;  // 无法满足
+            start = suffix >= file_size ? 0 : file_size - suffix;
+            stop = file_size - 1;
+        } else {
+            if (!parse_range_number(first, start)) return false;
+            if (last.empty()) {
+                stop = UINT64_MAX;
+            } else if (!parse_range_number(last, stop) || stop < start) {
+                return false;
+            }
+            if (start >= file_size) continue;  // 无法满足
+            stop = (std::min)(stop, file_size - 1);
+        }
+        
+        ranges.push_back(FileRange{std::string(), start, stop - start + 1});
+    }
+    
+    return spec_count > 0;
+}
+
+// If-None-Match中的ETag列表是否包含etag（弱比较，忽略W/前缀）
+static bool etag_list_matches(const std::string& list, const std::string& etag) {
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t comma = list.find(',', pos);
+        if (comma == std::string::npos) comma = list.size();
+        
+        size_t begin = list.find_first_not_of(" \t", pos);
+        size_t end = list.find_last_not_of(" \t", comma - 1);
+        pos = comma + 1;
+        if (begin == std::string::npos || begin >= comma || end < begin) continue;
+        
+        std::string candidate = list.substr(begin, end - begin + 1);
+        if (candidate == "*") return true;
+        if (candidate.compare(0, 2, "W/") == 0) candidate.erase(0, 2);
+        if (candidate == etag) return true;
+    }
+    return false;
+}
+
+bool HttpHandler::is_not_modified(const HttpRequest& request, const std::string& etag, int64_t modified_time) {
+    // 同时存在时以If-None-Match为准，忽略If-Modified-Since（RFC 7232 第6节）
+    const std::string* none_match = request.headers.get(HeaderId::IF_NONE_MATCH);
+    if (none_match) {
+        return etag_list_matches(*none_match, etag);
+    }
+    
+    const std::string* modified_since = request.headers.get(HeaderId::IF_MODIFIED_SINCE);
+    if (!modified_since || modified_time < 0) {
+        return false;
+    }
+    int64_t since;
+    return parse_http_date(*modified_since, since) && modified_time <= since;
+}
+
+bool HttpHandler::parse_http_date(const std::string& text, int64_t& unix_time) {
+    static const char* const months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                         "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    
+    // 只接受IMF-fixdate，例如"Sun, 06 Nov 1994 08:49:37 GMT"
+    int day, year, hour, minute, second;
+    char month_name[4] = {0};
+    if (std::sscanf(text.c_str(), "%*3s, %2d %3s %4d %2d:%2d:%2d GMT",
+                    &day, month_name, &year, &hour, &minute, &second) != 6) {
+        return false;
+    }
+    
+    int month = -1;
+    for (int i = 0; i < 12; ++i) {
+        if (std::strcmp(month_name, months[i]) == 0) {
+            month = i + 1;
+            break;
+        }
+    }
+    if (month < 0 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+    
+    // 公历日期转换为自1970-01-01以来的天数，不依赖timegm/_mkgmtime
+    int64_t y = year - (month <= 2 ? 1 : 0);
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t year_of_era = y - era * 400;
+    int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    int64_t days = era * 146097 + day_of_era - 719468;
+    
+    unix_time = days * 86400 + hour * 3600 + minute * 60 + second;
+    return true;
+}
+
+std::string HttpHandler::format_http_date(int64_t unix_time) {
+    static const char* const days[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static const char* const months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                         "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    
+    std::time_t time = static_cast<std::time_t>(unix_time);
+    std::tm utc;
+#ifdef _WIN32
+    gmtime_s(&utc, &time);
+#else
+    gmtime_r(&time, &utc);
+#endif
+    
+    // 不用strftime，避免受locale影响
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+                  days[utc.tm_wday], utc.tm_mday, months[utc.tm_mon], utc.tm_year + 1900,
+                  utc.tm_hour, utc.tm_min, utc.tm_sec);
+    return buffer;
+}
+
 HttpResponse HttpHandler::handle_list_files(const HttpRequest& request) {
     HttpResponse response;
     
@@ -425,6 +763,23 @@ HttpResponse HttpHandler::handle_list_files(const HttpRequest& request) {
     // 关键：确保Content-Type包含正确的字符集
     response.headers["Content-Type"] = "application/json; charset=utf-8";
     
+    // 列表的ETag取内容的FNV-1a哈希，文件增删改后列表内容变化，ETag随之变化
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : response.body) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    std::ostringstream etag_stream;
+    etag_stream << '"' << std::hex << hash << '"';
+    response.headers["ETag"] = etag_stream.str();
+    
+    if (is_not_modified(request, *response.headers.get(HeaderId::ETAG), -1)) {
+        std::cout << "文件列表未变化，返回304" << std::endl;
+        response.status_code = 304;
+        response.status_text = "Not Modified";
+        response.body.clear();
+        return response;
+    }
+    
     // 添加调试信息
     std::cout << "生成的JSON响应体长度: " << response.body.length() << std::endl;
     std::cout << "JSON响应体前200字符: " << response.body.substr(0, 200) << std::endl;
@@ -435,17 +790,8 @@ HttpResponse HttpHandler::handle_list_files(const HttpRequest& request) {
 HttpResponse HttpHandler::handle_delete_file(const HttpRequest& request) {
     HttpResponse response;
     
-    // 检查请求路径是否有效
-    if (request.path.length() < 9) {  // "/delete/" 长度为8
-        response.status_code = 400;
-        response.status_text = "Bad Request";
-        response.body = "无效的删除路径";
-        response.headers["Content-Type"] = "text/plain; charset=utf-8";
-        return response;
-    }
-    
-    // 提取文件名
-    std::string filename = request.path.substr(8); // 去掉"/delete/"
+    // 文件名为路由匹配出的{name}参数
+    std::string filename = request.name;
     
     // 检查提取的文件名是否为空
     if (filename.empty()) {
@@ -667,39 +1013,6 @@ std::string HttpHandler::url_encode(const std::string& str) {
     return result;
 }
 
-std::vector<std::string> HttpHandler::parse_headers(const std::string& header_text) {
-    std::vector<std::string> headers;
-    std::istringstream stream(header_text);
-    std::string line;
-    
-    while (std::getline(stream, line)) {
-        if (line.back() == '\r') line.pop_back();
-        if (!line.empty()) {
-            headers.push_back(line);
-        }
-    }
-    
-    return headers;
-}
-
-std::pair<std::string, std::string> HttpHandler::parse_header_line(const std::string& line) {
-    size_t colon_pos = line.find(':');
-    if (colon_pos == std::string::npos) {
-        return {"", ""};
-    }
-    
-    std::string key = line.substr(0, colon_pos);
-    std::string value = line.substr(colon_pos + 1);
-    
-    // 去除首尾空格
-    key.erase(0, key.find_first_not_of(" \t"));
-    key.erase(key.find_last_not_of(" \t") + 1);
-    value.erase(0, value.find_first_not_of(" \t"));
-    value.erase(value.find_last_not_of(" \t") + 1);
-    
-    return {key, value};
-} 
-
 //文件名解析
 std::string HttpHandler::file_name_url_decode(const std::string& src) {
 	std::string ret;
@@ -748,6 +1061,7 @@ std::string HttpHandler::parse_filename(const std::string& part) {
 }
 
 std::string HttpHandler:: utf8_to_acp(const std::string& utf8) {
+#ifdef _WIN32
 	// UTF-8 -> UTF-16
 	int wlen = MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, NULL, 0);
 	std::wstring wbuf(wlen, 0);
@@ -759,6 +1073,10 @@ std::string HttpHandler:: utf8_to_acp(const std::string& utf8) {
 	WideCharToMultiByte(CP_ACP, 0, wbuf.c_str(), -1, &abuf[0], alen, NULL, NULL);
 
 	return abuf;
+#else
+	// 非Windows系统文件名本身就是UTF-8，无需转换
+	return utf8;
+#endif
 }
 
 // UTF-8 → wstring
@@ -20,6 +20,7 @@
 #include "../include/server.h"
 #include "../include/file_manager.h"
 #include "../include/performance_config.h"
+#include "../include/simd_scan.h"
 
 Server* g_server = nullptr;
 
@@ -147,6 +148,7 @@ void print_performance_info() {
     std::cout << "最大上传大小: " << PerformanceConfig::MAX_UPLOAD_SIZE / (1024 * 1024) << " MB" << std::endl;
     std::cout << "连接超时: " << PerformanceConfig::CONNECTION_TIMEOUT_MS << " ms" << std::endl;
     std::cout << "请求超时: " << PerformanceConfig::REQUEST_TIMEOUT_MS << " ms" << std::endl;
+    std::cout << "报文扫描指令集: " << SimdScan::instruction_set() << std::endl;
     
 #ifdef _WIN32
     std::cout << "IOCP最大并发I/O: " << PerformanceConfig::IOCP_MAX_CONCURRENT_IO << std::endl;
@@ -172,6 +174,8 @@ int main(int argc, char* argv[]) {
     std::string address = "127.0.0.1";
     size_t max_connections = PerformanceConfig::DEFAULT_MAX_CONNECTIONS;
     size_t thread_pool_size = PerformanceConfig::DEFAULT_THREAD_POOL_SIZE;
+    ReactorMode reactor_mode = ReactorMode::SHARED_ACCEPTOR;
+    IoBackend io_backend = IoBackend::EPOLL;
     
     // 解析命令行参数
     if (argc > 1) {
@@ -183,12 +187,22 @@ int main(int argc, char* argv[]) {
     if (argc > 3) {
         thread_pool_size = std::stoul(argv[3]);
     }
+    if (argc > 4 && std::string(argv[4]) == "reuseport") {
+        // 每核一个SO_REUSEPORT事件循环，此时不使用工作线程池
+        reactor_mode = ReactorMode::REUSEPORT_PER_CORE;
+    }
+    if (argc > 5 && std::string(argv[5]) == "uring") {
+        // Linux下使用io_uring事件循环，内核不支持时回退到epoll
+        io_backend = IoBackend::IO_URING;
+    }
     
     std::cout << "🚀 启动高性能异步文件服务器" << std::endl;
     std::cout << "==========================================" << std::endl;
     std::cout << "端口: " << port << std::endl;
     std::cout << "最大连接数: " << max_connections << std::endl;
     std::cout << "工作线程数: " << thread_pool_size << std::endl;
+    std::cout << "反应器模式: " << (reactor_mode == ReactorMode::REUSEPORT_PER_CORE ? "reuseport" : "shared") << std::endl;
+    std::cout << "I/O后端: " << (io_backend == IoBackend::IO_URING ? "io_uring" : "epoll") << std::endl;
     
     print_performance_info();
     
@@ -215,6 +229,8 @@ int main(int argc, char* argv[]) {
     
     // 创建并启动高性能服务器
     Server server(address,port, max_connections, thread_pool_size);
+    server.set_reactor_mode(reactor_mode);
+    server.set_io_backend(io_backend);
     g_server = &server;
     
     if (!server.start()) {
@@ -232,6 +248,7 @@ int main(int argc, char* argv[]) {
             std::cout << "  总请求数: " << server.get_total_requests() << std::endl;
             std::cout << "  请求/秒: " << std::fixed << std::setprecision(2) 
                       << server.get_requests_per_second() << std::endl;
+            server.print_lane_stats();
         }
     });
     
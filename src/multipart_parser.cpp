@@ -0,0 +1,123 @@
+#include "../include/multipart_parser.h"
+#include "../include/simd_scan.h"
+#include <algorithm>
+#include <cstring>
+
+MultipartParser::MultipartParser(const std::string& boundary, Handler& handler)
+    : handler_(handler),
+      delimiter_("\r\n--" + boundary),
+      state_(State::PREAMBLE),
+      // 第一个分隔行前面可能没有换行，补上"\r\n"后与其他分隔行同样处理
+      carry_("\r\n") {
+}
+
+bool MultipartParser::feed(const char* data, size_t length) {
+    // 上一段留下的尾部与新数据开头拼接处理，每次只拼接不超过一个分隔行长度，拷贝量有限
+    while (!carry_.empty() && length > 0 && state_ != State::DONE && state_ != State::FAILED) {
+        size_t old_size = carry_.size();
+        size_t take = (std::min)(length, delimiter_.size());
+        carry_.append(data, take);
+
+        size_t used = parse(carry_.data(), carry_.size());
+        if (used >= old_size) {
+            // 尾部已处理完，新数据中未处理的部分直接从原始缓冲区继续
+            size_t from_data = used - old_size;
+            carry_.clear();
+            data += from_data;
+            length -= from_data;
+        } else {
+            carry_.erase(0, used);
+            data += take;
+            length -= take;
+        }
+    }
+
+    if (carry_.empty() && length > 0) {
+        size_t used = parse(data, length);
+        carry_.assign(data + used, length - used);
+    }
+
+    return state_ != State::FAILED;
+}
+
+size_t MultipartParser::parse(const char* data, size_t length) {
+    size_t pos = 0;
+    while (pos < length) {
+        switch (state_) {
+        case State::PREAMBLE:
+        case State::BODY: {
+            size_t found = find_delimiter(data + pos, length - pos);
+            if (found == length - pos) {
+                // 没有完整的分隔行：末尾可能是分隔行的开头，保留到下一段
+                size_t keep = (std::min)(length - pos, delimiter_.size() - 1);
+                size_t emit = length - pos - keep;
+                if (state_ == State::BODY && emit > 0) {
+                    handler_.on_part_data(data + pos, emit);
+                }
+                return pos + emit;
+            }
+
+            if (state_ == State::BODY) {
+                if (found > 0) {
+                    handler_.on_part_data(data + pos, found);
+                }
+                handler_.on_part_end();
+            }
+            pos += found + delimiter_.size();
+            state_ = State::AFTER_DELIMITER;
+            break;
+        }
+
+        case State::AFTER_DELIMITER:
+            if (length - pos < 2) {
+                return pos;
+            }
+            if (data[pos] == '-' && data[pos + 1] == '-') {
+                // 结束分隔行，之后的尾声部分忽略
+                state_ = State::DONE;
+                return length;
+            }
+            if (data[pos] != '\r' || data[pos + 1] != '\n') {
+                state_ = State::FAILED;
+                return length;
+            }
+            pos += 2;
+            // 以分隔行末尾的换行开头，头部为空时同样能匹配到"\r\n\r\n"
+            headers_.assign("\r\n");
+            state_ = State::HEADERS;
+            break;
+
+        case State::HEADERS: {
+            size_t old_size = headers_.size();
+            size_t take = (std::min)(length - pos, MAX_PART_HEADER_SIZE + 4 - (std::min)(old_size, MAX_PART_HEADER_SIZE + 4));
+            headers_.append(data + pos, take);
+
+            size_t from = old_size >= 3 ? old_size - 3 : 0;
+            size_t end = from + SimdScan::find_header_end(headers_.data() + from, headers_.size() - from);
+            if (end == headers_.size()) {
+                if (headers_.size() >= MAX_PART_HEADER_SIZE + 4) {
+                    state_ = State::FAILED;
+                    return length;
+                }
+                pos += take;
+                break;
+            }
+
+            pos += end + 4 - old_size;
+            handler_.on_part_begin(end > 2 ? headers_.substr(2, end - 2) : std::string());
+            headers_.clear();
+            state_ = State::BODY;
+            break;
+        }
+
+        case State::DONE:
+        case State::FAILED:
+            return length;
+        }
+    }
+    return pos;
+}
+
+size_t MultipartParser::find_delimiter(const char* data, size_t length) const {
+    return SimdScan::find(data, length, delimiter_.data(), delimiter_.size());
+}
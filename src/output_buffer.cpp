@@ -0,0 +1,156 @@
+#include "../include/output_buffer.h"
+#include "../include/performance_config.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+struct OutputBuffer::Segment {
+    char data[PerformanceConfig::OUTPUT_SEGMENT_SIZE];
+};
+
+namespace {
+    // 每个线程一个空闲段列表，分配和归还都不加锁；线程退出时释放
+    struct SegmentPool {
+        std::vector<void*> free_segments;
+
+        ~SegmentPool() {
+            for (void* segment : free_segments) {
+                ::operator delete(segment);
+            }
+        }
+    };
+
+    thread_local SegmentPool segment_pool;
+}
+
+OutputBuffer::OutputBuffer() : size_(0) {}
+
+OutputBuffer::~OutputBuffer() {
+    clear();
+}
+
+OutputBuffer::Segment* OutputBuffer::allocate_segment() {
+    std::vector<void*>& free_segments = segment_pool.free_segments;
+    if (!free_segments.empty()) {
+        void* segment = free_segments.back();
+        free_segments.pop_back();
+        return static_cast<Segment*>(segment);
+    }
+    return static_cast<Segment*>(::operator new(sizeof(Segment)));
+}
+
+void OutputBuffer::release_segment(Segment* segment) {
+    std::vector<void*>& free_segments = segment_pool.free_segments;
+    if (free_segments.size() < PerformanceConfig::OUTPUT_SEGMENT_POOL_SIZE) {
+        free_segments.push_back(segment);
+    } else {
+        ::operator delete(segment);
+    }
+}
+
+const char* OutputBuffer::Chunk::data() const {
+    return segment ? segment->data : owned.data();
+}
+
+void OutputBuffer::append(const char* data, size_t length) {
+    size_ += length;
+    while (length > 0) {
+        // 尾节点是未写满的内存段时继续写入，否则新开一段
+        if (chunks_.empty() || !chunks_.back().segment ||
+            chunks_.back().end == PerformanceConfig::OUTPUT_SEGMENT_SIZE) {
+            chunks_.push_back(Chunk{allocate_segment(), std::string(), nullptr, 0, 0});
+        }
+
+        Chunk& tail = chunks_.back();
+        size_t count = (std::min)(length, static_cast<size_t>(PerformanceConfig::OUTPUT_SEGMENT_SIZE - tail.end));
+        std::memcpy(tail.segment->data + tail.end, data, count);
+        tail.end += count;
+        data += count;
+        length -= count;
+    }
+}
+
+void OutputBuffer::append(std::string&& data) {
+    if (data.size() < PerformanceConfig::OUTPUT_SEGMENT_SIZE) {
+        append(data.data(), data.size());
+        return;
+    }
+
+    // 先加入空节点再移入字符串：用聚合临时对象移动时，GCC在-O3 -flto下会误判移动后的短字符串缓冲区而报
+    // -Wstringop-overflow
+    size_t length = data.size();
+    Chunk& chunk = chunks_.emplace_back();
+    chunk.owned = std::move(data);
+    chunk.end = length;
+    size_ += length;
+}
+
+void OutputBuffer::append_file(std::shared_ptr<FileBody> file, uint64_t offset, uint64_t length) {
+    if (length == 0) return;
+    chunks_.push_back(Chunk{nullptr, std::string(), std::move(file), offset, offset + length});
+    size_ += length;
+}
+
+const FileBody* OutputBuffer::front_file(uint64_t& offset, uint64_t& length) const {
+    if (chunks_.empty() || !chunks_.front().file) {
+        return nullptr;
+    }
+    const Chunk& front = chunks_.front();
+    offset = front.begin;
+    length = front.end - front.begin;
+    return front.file.get();
+}
+
+void OutputBuffer::pop_front() {
+    Chunk& front = chunks_.front();
+    if (front.segment) {
+        release_segment(front.segment);
+    }
+    chunks_.pop_front();
+}
+
+void OutputBuffer::consume(uint64_t n) {
+    n = (std::min)(n, size_);
+    size_ -= n;
+    while (n > 0) {
+        Chunk& front = chunks_.front();
+        uint64_t available = front.end - front.begin;
+        if (n < available) {
+            front.begin += n;
+            return;
+        }
+        n -= available;
+        pop_front();
+    }
+}
+
+void OutputBuffer::clear() {
+    while (!chunks_.empty()) {
+        pop_front();
+    }
+    size_ = 0;
+}
+
+#ifdef _WIN32
+size_t OutputBuffer::fill(WSABUF* buffers, size_t max_count, size_t max_bytes) const {
+#else
+size_t OutputBuffer::fill(struct iovec* buffers, size_t max_count, size_t max_bytes) const {
+#endif
+    size_t count = 0;
+    for (const Chunk& chunk : chunks_) {
+        if (count == max_count || max_bytes == 0 || chunk.file) break;
+
+        size_t length = static_cast<size_t>((std::min)(chunk.end - chunk.begin, static_cast<uint64_t>(max_bytes)));
+        char* data = const_cast<char*>(chunk.data() + chunk.begin);
+#ifdef _WIN32
+        buffers[count].buf = data;
+        buffers[count].len = static_cast<ULONG>(length);
+#else
+        buffers[count].iov_base = data;
+        buffers[count].iov_len = length;
+#endif
+        count++;
+        max_bytes -= length;
+    }
+    return count;
+}
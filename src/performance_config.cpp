@@ -0,0 +1,8 @@
+#include "../include/performance_config.h"
+
+namespace PerformanceConfig {
+
+    // 全局性能监控实例
+    PerformanceMetrics global_metrics;
+
+}
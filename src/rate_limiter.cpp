@@ -0,0 +1,181 @@
+#include "../include/rate_limiter.h"
+#include <algorithm>
+#include <functional>
+
+TokenBucket::TokenBucket(double rate, double burst, Clock::time_point now)
+    : rate_(rate), burst_(burst), tokens_(burst), last_refill_(now) {}
+
+void TokenBucket::refill(Clock::time_point now) {
+    if (now <= last_refill_) return;
+    std::chrono::duration<double> elapsed = now - last_refill_;
+    tokens_ = (std::min)(burst_, tokens_ + elapsed.count() * rate_);
+    last_refill_ = now;
+}
+
+size_t TokenBucket::take(size_t wanted, Clock::time_point now) {
+    refill(now);
+    size_t taken = (std::min)(wanted, static_cast<size_t>(tokens_));
+    tokens_ -= static_cast<double>(taken);
+    return taken;
+}
+
+void TokenBucket::give_back(size_t count) {
+    tokens_ = (std::min)(burst_, tokens_ + static_cast<double>(count));
+}
+
+bool TokenBucket::full(Clock::time_point now) {
+    refill(now);
+    return tokens_ >= burst_;
+}
+
+AtomicTokenBucket::AtomicTokenBucket(uint64_t rate, uint64_t burst, Clock::time_point now)
+    : rate_(rate), burst_(burst), tokens_(burst),
+      last_refill_(std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count()) {}
+
+void AtomicTokenBucket::refill(Clock::time_point now) {
+    int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+    int64_t last = last_refill_.load(std::memory_order_relaxed);
+    if (now_ns <= last || rate_ == 0) return;
+
+    // 不足一个令牌的时间留到下次补充；空闲超过一个burst的时间直接充满
+    double elapsed = static_cast<double>(now_ns - last) / 1e9;
+    double tokens = elapsed * static_cast<double>(rate_);
+    uint64_t added;
+    int64_t next;
+    if (tokens >= static_cast<double>(burst_)) {
+        added = burst_;
+        next = now_ns;
+    } else {
+        added = static_cast<uint64_t>(tokens);
+        if (added == 0) return;
+        next = last + static_cast<int64_t>(static_cast<double>(added) * 1e9 / static_cast<double>(rate_));
+    }
+
+    // 只有推进了补充时间的线程加入令牌，同一段时间不会被补充两次
+    if (!last_refill_.compare_exchange_strong(last, next, std::memory_order_relaxed)) {
+        return;
+    }
+    give_back(added);
+}
+
+size_t AtomicTokenBucket::take(size_t wanted, Clock::time_point now) {
+    refill(now);
+    uint64_t current = tokens_.load(std::memory_order_relaxed);
+    uint64_t taken;
+    do {
+        taken = (std::min)(static_cast<uint64_t>(wanted), current);
+        if (taken == 0) return 0;
+    } while (!tokens_.compare_exchange_weak(current, current - taken, std::memory_order_relaxed));
+    return static_cast<size_t>(taken);
+}
+
+void AtomicTokenBucket::give_back(size_t count) {
+    uint64_t current = tokens_.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        next = (std::min)(burst_, current + static_cast<uint64_t>(count));
+    } while (!tokens_.compare_exchange_weak(current, next, std::memory_order_relaxed));
+}
+
+RateLimiter::RateLimiter(size_t client_requests_per_second, size_t client_bytes_per_second,
+                         size_t global_requests_per_second, size_t global_bytes_per_second,
+                         size_t shard_count)
+    : client_requests_per_second_(client_requests_per_second),
+      client_bytes_per_second_(client_bytes_per_second),
+      global_requests_(global_requests_per_second, global_requests_per_second, TokenBucket::Clock::now()),
+      global_bytes_(global_bytes_per_second, global_bytes_per_second, TokenBucket::Clock::now()),
+      limited_requests_(0), throttled_sends_(0) {
+    shard_count = (std::max)(shard_count, size_t(1));
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+RateLimiter::Shard& RateLimiter::shard_for(const std::string& client_ip) {
+    return *shards_[std::hash<std::string>()(client_ip) % shards_.size()];
+}
+
+RateLimiter::ClientBuckets& RateLimiter::buckets_for(Shard& shard, const std::string& client_ip,
+                                                     TokenBucket::Clock::time_point now) {
+    auto it = shard.clients.find(client_ip);
+    if (it != shard.clients.end()) {
+        return it->second;
+    }
+
+    // 分片变大时顺带清理空闲客户端：桶已充满说明至少一秒没有活动，删除后重建的效果相同
+    if (shard.clients.size() >= shard.sweep_threshold) {
+        for (auto entry = shard.clients.begin(); entry != shard.clients.end();) {
+            if (entry->second.requests.full(now) && entry->second.bytes.full(now)) {
+                entry = shard.clients.erase(entry);
+            } else {
+                ++entry;
+            }
+        }
+        shard.sweep_threshold = (std::max)(size_t(1024), shard.clients.size() * 2);
+    }
+
+    double requests = static_cast<double>(client_requests_per_second_);
+    double bytes = static_cast<double>(client_bytes_per_second_);
+    return shard.clients.emplace(client_ip, ClientBuckets{TokenBucket(requests, requests, now),
+                                                          TokenBucket(bytes, bytes, now)}).first->second;
+}
+
+bool RateLimiter::allow_request(const std::string& client_ip) {
+    auto now = TokenBucket::Clock::now();
+    Shard& shard = shard_for(client_ip);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    ClientBuckets& client = buckets_for(shard, client_ip, now);
+    if (client.requests.take(1, now) == 1) {
+        if (global_requests_.take(1, now) == 1) {
+            return true;
+        }
+        client.requests.give_back(1);
+    }
+
+    limited_requests_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+size_t RateLimiter::acquire_bytes(const std::string& client_ip, size_t wanted) {
+    if (wanted == 0) return 0;
+
+    auto now = TokenBucket::Clock::now();
+    Shard& shard = shard_for(client_ip);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    ClientBuckets& client = buckets_for(shard, client_ip, now);
+    size_t granted = client.bytes.take(wanted, now);
+    if (granted > 0) {
+        size_t global_granted = global_bytes_.take(granted, now);
+        client.bytes.give_back(granted - global_granted);
+        granted = global_granted;
+    }
+
+    if (granted == 0) {
+        throttled_sends_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return granted;
+}
+
+void RateLimiter::refund_bytes(const std::string& client_ip, size_t unused) {
+    if (unused == 0) return;
+
+    auto now = TokenBucket::Clock::now();
+    Shard& shard = shard_for(client_ip);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    buckets_for(shard, client_ip, now).bytes.give_back(unused);
+    global_bytes_.give_back(unused);
+}
+
+RateLimiter::Metrics RateLimiter::get_metrics() const {
+    Metrics metrics;
+    metrics.clients = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        metrics.clients += shard->clients.size();
+    }
+    metrics.limited_requests = limited_requests_.load(std::memory_order_relaxed);
+    metrics.throttled_sends = throttled_sends_.load(std::memory_order_relaxed);
+    return metrics;
+}
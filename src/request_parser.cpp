@@ -0,0 +1,149 @@
+#include "../include/request_parser.h"
+#include "../include/header_map.h"
+
+#include <cstring>
+
+namespace {
+    bool is_space(char c) {
+        return c == ' ' || c == '\t';
+    }
+}
+
+RequestParser::RequestParser() {
+    reset();
+}
+
+void RequestParser::reset() {
+    base_ = nullptr;
+    status_ = Status::INCOMPLETE;
+    stage_ = Stage::REQUEST_LINE;
+    line_start_ = 0;
+    scanned_ = 0;
+    method_ = Span{0, 0};
+    path_ = Span{0, 0};
+    version_ = Span{0, 0};
+    header_count_ = 0;
+}
+
+RequestParser::Status RequestParser::parse(std::string_view buffer) {
+    base_ = buffer.data();
+    if (status_ != Status::INCOMPLETE) {
+        return status_;
+    }
+
+    while (true) {
+        const char* newline = nullptr;
+        if (scanned_ < buffer.size()) {
+            newline = static_cast<const char*>(
+                std::memchr(buffer.data() + scanned_, '\n', buffer.size() - scanned_));
+        }
+        if (!newline) {
+            scanned_ = buffer.size();
+            if (buffer.size() > PerformanceConfig::MAX_REQUEST_HEADER_SIZE) {
+                status_ = Status::INVALID;
+            }
+            return status_;
+        }
+
+        size_t line_end = static_cast<size_t>(newline - buffer.data());
+        size_t next_line = line_end + 1;
+        if (next_line > PerformanceConfig::MAX_REQUEST_HEADER_SIZE) {
+            status_ = Status::INVALID;
+            return status_;
+        }
+        // 行尾的"\r"不属于内容，只有"\n"结尾的行同样接受
+        if (line_end > line_start_ && buffer[line_end - 1] == '\r') {
+            --line_end;
+        }
+
+        bool ok = true;
+        if (line_end == line_start_) {
+            // 空行：请求行之前的空行忽略，头部之后的空行表示头部结束
+            if (stage_ == Stage::HEADERS) {
+                stage_ = Stage::DONE;
+            }
+        } else if (stage_ == Stage::REQUEST_LINE) {
+            ok = parse_request_line(line_start_, line_end);
+            stage_ = Stage::HEADERS;
+        } else {
+            ok = parse_header_line(line_start_, line_end);
+        }
+
+        line_start_ = next_line;
+        scanned_ = next_line;
+        if (!ok) {
+            status_ = Status::INVALID;
+            return status_;
+        }
+        if (stage_ == Stage::DONE) {
+            status_ = Status::COMPLETE;
+            return status_;
+        }
+    }
+}
+
+bool RequestParser::parse_request_line(size_t begin, size_t end) {
+    // "方法 路径 版本"，以空格分隔；缺少版本时按空版本处理，多余的部分视为格式错误
+    Span* parts[3] = {&method_, &path_, &version_};
+    size_t count = 0;
+    size_t pos = begin;
+    while (pos < end) {
+        while (pos < end && is_space(base_[pos])) ++pos;
+        if (pos == end) break;
+        size_t token_start = pos;
+        while (pos < end && !is_space(base_[pos])) ++pos;
+        if (count == 3) {
+            return false;
+        }
+        *parts[count++] = Span{static_cast<uint32_t>(token_start), static_cast<uint32_t>(pos - token_start)};
+    }
+    return count >= 2;
+}
+
+bool RequestParser::parse_header_line(size_t begin, size_t end) {
+    const char* line = base_ + begin;
+    const char* colon = static_cast<const char*>(std::memchr(line, ':', end - begin));
+    if (!colon) {
+        // 没有冒号的行（例如已废弃的折行）忽略
+        return true;
+    }
+
+    size_t name_begin = begin;
+    size_t name_end = static_cast<size_t>(colon - base_);
+    size_t value_begin = name_end + 1;
+    size_t value_end = end;
+    while (name_begin < name_end && is_space(base_[name_begin])) ++name_begin;
+    while (name_end > name_begin && is_space(base_[name_end - 1])) --name_end;
+    while (value_begin < value_end && is_space(base_[value_begin])) ++value_begin;
+    while (value_end > value_begin && is_space(base_[value_end - 1])) --value_end;
+    if (name_begin == name_end) {
+        return true;
+    }
+
+    // 重复的Content-Length无法确定body在哪里结束，后续请求会错位；重复的Host无法确定请求的目标。
+    // 两者都不能只取其中一个，整个请求视为格式错误
+    std::string_view name(base_ + name_begin, name_end - name_begin);
+    std::string_view existing;
+    if ((HeaderMap::equals_ignore_case(name, "Content-Length") || HeaderMap::equals_ignore_case(name, "Host")) &&
+        find_header(name, existing)) {
+        return false;
+    }
+
+    if (header_count_ == PerformanceConfig::MAX_REQUEST_HEADERS) {
+        return false;
+    }
+    Field& field = headers_[header_count_++];
+    field.name = Span{static_cast<uint32_t>(name_begin), static_cast<uint32_t>(name_end - name_begin)};
+    field.value = Span{static_cast<uint32_t>(value_begin), static_cast<uint32_t>(value_end - value_begin)};
+    return true;
+}
+
+bool RequestParser::find_header(std::string_view name, std::string_view& value) const {
+    for (size_t i = 0; i < header_count_; ++i) {
+        if (HeaderMap::equals_ignore_case(view(headers_[i].name), name)) {
+            value = view(headers_[i].value);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,242 @@
+#include "../include/response_writer.h"
+#include "../include/http_handler.h"
+#include "../include/performance_config.h"
+
+#include <cstring>
+#include <ctime>
+#include <utility>
+
+namespace {
+    // 常用状态码的完整状态行
+    std::string_view cached_status_line(int status_code) {
+        switch (status_code) {
+            case 100: return "HTTP/1.1 100 Continue\r\n";
+            case 200: return "HTTP/1.1 200 OK\r\n";
+            case 201: return "HTTP/1.1 201 Created\r\n";
+            case 204: return "HTTP/1.1 204 No Content\r\n";
+            case 206: return "HTTP/1.1 206 Partial Content\r\n";
+            case 207: return "HTTP/1.1 207 Multi-Status\r\n";
+            case 304: return "HTTP/1.1 304 Not Modified\r\n";
+            case 400: return "HTTP/1.1 400 Bad Request\r\n";
+            case 403: return "HTTP/1.1 403 Forbidden\r\n";
+            case 404: return "HTTP/1.1 404 Not Found\r\n";
+            case 405: return "HTTP/1.1 405 Method Not Allowed\r\n";
+            case 408: return "HTTP/1.1 408 Request Timeout\r\n";
+            case 411: return "HTTP/1.1 411 Length Required\r\n";
+            case 413: return "HTTP/1.1 413 Payload Too Large\r\n";
+            case 416: return "HTTP/1.1 416 Range Not Satisfiable\r\n";
+            case 417: return "HTTP/1.1 417 Expectation Failed\r\n";
+            case 429: return "HTTP/1.1 429 Too Many Requests\r\n";
+            case 500: return "HTTP/1.1 500 Internal Server Error\r\n";
+            case 501: return "HTTP/1.1 501 Not Implemented\r\n";
+            case 503: return "HTTP/1.1 503 Service Unavailable\r\n";
+            default: return std::string_view();
+        }
+    }
+
+    // "HTTP/1.1 200 "的长度
+    constexpr size_t STATUS_LINE_PREFIX = 13;
+
+    const char DIGIT_PAIRS[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+    // Date头：同一秒内的响应复用上次格式化的结果
+    struct DateCache {
+        int64_t second = -1;
+        char text[64];
+        size_t length = 0;
+    };
+
+    thread_local DateCache date_cache;
+}
+
+ResponseHead::ResponseHead(const ResponseHead& other) {
+    assign(other);
+}
+
+ResponseHead& ResponseHead::operator=(const ResponseHead& other) {
+    if (this != &other) {
+        assign(other);
+    }
+    return *this;
+}
+
+ResponseHead::ResponseHead(ResponseHead&& other) noexcept
+    : size_(other.size_), overflow_(std::move(other.overflow_)) {
+    if (overflow_.empty()) {
+        std::memcpy(inline_, other.inline_, size_);
+    }
+    other.size_ = 0;
+    other.overflow_.clear();
+}
+
+ResponseHead& ResponseHead::operator=(ResponseHead&& other) noexcept {
+    if (this != &other) {
+        size_ = other.size_;
+        overflow_ = std::move(other.overflow_);
+        if (overflow_.empty()) {
+            std::memcpy(inline_, other.inline_, size_);
+        }
+        other.size_ = 0;
+        other.overflow_.clear();
+    }
+    return *this;
+}
+
+void ResponseHead::assign(const ResponseHead& other) {
+    size_ = other.size_;
+    overflow_ = other.overflow_;
+    if (overflow_.empty()) {
+        std::memcpy(inline_, other.inline_, size_);
+    }
+}
+
+void ResponseHead::append(const char* data, size_t length) {
+    if (overflow_.empty() && size_ + length <= INLINE_CAPACITY) {
+        std::memcpy(inline_ + size_, data, length);
+        size_ += length;
+        return;
+    }
+
+    if (overflow_.empty()) {
+        overflow_.reserve(size_ + length);
+        overflow_.assign(inline_, size_);
+    }
+    overflow_.append(data, length);
+    size_ += length;
+}
+
+std::string_view ResponseWriter::status_text(int status_code) {
+    std::string_view line = cached_status_line(status_code);
+    if (line.empty()) {
+        return line;
+    }
+    return line.substr(STATUS_LINE_PREFIX, line.size() - STATUS_LINE_PREFIX - 2);
+}
+
+void ResponseWriter::append_uint(ResponseHead& out, uint64_t value) {
+    // 从后往前每次写两位
+    char buffer[20];
+    char* end = buffer + sizeof(buffer);
+    char* pos = end;
+    while (value >= 100) {
+        size_t pair = static_cast<size_t>(value % 100) * 2;
+        value /= 100;
+        pos -= 2;
+        pos[0] = DIGIT_PAIRS[pair];
+        pos[1] = DIGIT_PAIRS[pair + 1];
+    }
+    if (value >= 10) {
+        size_t pair = static_cast<size_t>(value) * 2;
+        pos -= 2;
+        pos[0] = DIGIT_PAIRS[pair];
+        pos[1] = DIGIT_PAIRS[pair + 1];
+    } else {
+        *--pos = static_cast<char>('0' + value);
+    }
+    out.append(pos, static_cast<size_t>(end - pos));
+}
+
+void ResponseWriter::append_date(ResponseHead& out) {
+    int64_t now = static_cast<int64_t>(std::time(nullptr));
+    if (date_cache.second != now) {
+        std::string date = HttpHandler::format_http_date(now);
+        std::memcpy(date_cache.text, "Date: ", 6);
+        std::memcpy(date_cache.text + 6, date.data(), date.size());
+        std::memcpy(date_cache.text + 6 + date.size(), "\r\n", 2);
+        date_cache.length = 6 + date.size() + 2;
+        date_cache.second = now;
+    }
+    out.append(date_cache.text, date_cache.length);
+}
+
+void ResponseWriter::append_status_line(ResponseHead& out, int status_code, std::string_view text) {
+    // 原因短语与标准一致时使用缓存的状态行
+    std::string_view line = cached_status_line(status_code);
+    if (!line.empty() && (text.empty() || text == status_text(status_code))) {
+        out.append(line);
+        return;
+    }
+    out.append("HTTP/1.1 ", 9);
+    append_uint(out, static_cast<uint64_t>(status_code));
+    out.append(" ", 1);
+    out.append(text);
+    out.append("\r\n", 2);
+}
+
+void ResponseWriter::append_connection(ResponseHead& out, bool keep_alive) {
+    if (keep_alive) {
+        out.append("Connection: keep-alive\r\nKeep-Alive: timeout=");
+        append_uint(out, PerformanceConfig::KEEP_ALIVE_TIMEOUT_MS / 1000);
+        out.append("\r\n", 2);
+    } else {
+        out.append("Connection: close\r\n");
+    }
+}
+
+void ResponseWriter::write_head(const HttpResponse& response, ResponseHead& out) {
+    append_status_line(out, response.status_code, response.status_text);
+    append_date(out);
+
+    // 304没有body，不发送Content-Length和Content-Type，以免覆盖缓存中的实体头
+    bool not_modified = response.status_code == 304;
+    if (!not_modified) {
+        out.append("Content-Length: ");
+        append_uint(out, response.content_length());
+        out.append("\r\n", 2);
+
+        // 未指定时默认text/plain；没有字符集的补上utf-8（multipart的各段自带Content-Type，不加）
+        const std::string* content_type = response.headers.get(HeaderId::CONTENT_TYPE);
+        out.append("Content-Type: ");
+        if (!content_type) {
+            out.append("text/plain; charset=utf-8\r\n");
+        } else {
+            out.append(*content_type);
+            if (content_type->find("charset=") == std::string::npos &&
+                content_type->compare(0, 10, "multipart/") != 0) {
+                out.append("; charset=utf-8");
+            }
+            out.append("\r\n", 2);
+        }
+    }
+
+    // 未指定时默认短连接，持久连接由调用方设置Connection头
+    if (!response.headers.contains(HeaderId::CONNECTION)) {
+        out.append("Connection: close\r\n");
+    }
+
+    for (const HeaderMap::Header& header : response.headers) {
+        if (header.id != HeaderId::CONTENT_TYPE && header.id != HeaderId::CONTENT_LENGTH) {
+            out.append(header.name);
+            out.append(": ", 2);
+            out.append(header.value);
+            out.append("\r\n", 2);
+        }
+    }
+
+    out.append("\r\n", 2);
+}
+
+void ResponseWriter::write_simple(int status_code, std::string_view content_type, std::string_view body,
+                                  bool keep_alive, std::string_view extra_headers, ResponseHead& out) {
+    append_status_line(out, status_code, status_text(status_code));
+    append_date(out);
+    out.append("Content-Length: ");
+    append_uint(out, body.size());
+    out.append("\r\nContent-Type: ");
+    out.append(content_type);
+    out.append("\r\n", 2);
+    append_connection(out, keep_alive);
+    out.append(extra_headers);
+    out.append("\r\n", 2);
+    out.append(body);
+}
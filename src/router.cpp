@@ -0,0 +1,127 @@
+#include "../include/router.h"
+
+HttpMethod parse_method(std::string_view method) {
+    switch (method.size()) {
+        case 3:
+            if (method == "GET") return HttpMethod::HTTP_GET;
+            if (method == "PUT") return HttpMethod::HTTP_PUT;
+            break;
+        case 4:
+            if (method == "POST") return HttpMethod::HTTP_POST;
+            break;
+        case 6:
+            if (method == "DELETE") return HttpMethod::HTTP_DELETE;
+            break;
+        default:
+            break;
+    }
+    return HttpMethod::HTTP_OTHER;
+}
+
+Router::Router() {
+    for (size_t& root : roots_) {
+        root = new_node(std::string_view());
+    }
+}
+
+size_t Router::new_node(std::string_view segment) {
+    nodes_.push_back(Node{std::string(segment), {}, NONE, -1, -1});
+    return nodes_.size() - 1;
+}
+
+void Router::add(HttpMethod method, std::string_view pattern, int target) {
+    if (method == HttpMethod::HTTP_OTHER || pattern.empty() || pattern[0] != '/') {
+        return;
+    }
+
+    // 节点保存在vector中，新建节点可能使引用失效，全程使用下标
+    size_t node = roots_[static_cast<size_t>(method)];
+    size_t pos = 0;
+    while (pos < pattern.size()) {
+        size_t start = pos + 1;
+        size_t end = pattern.find('/', start);
+        if (end == std::string_view::npos) {
+            end = pattern.size();
+        }
+        std::string_view segment = pattern.substr(start, end - start);
+        pos = end;
+
+        if (segment.size() >= 3 && segment.front() == '{' && segment.compare(segment.size() - 2, 2, "*}") == 0) {
+            nodes_[node].rest_target = target;
+            return;
+        }
+        if (segment.size() >= 2 && segment.front() == '{' && segment.back() == '}') {
+            if (nodes_[node].param_child == NONE) {
+                size_t child = new_node(std::string_view());
+                nodes_[node].param_child = child;
+            }
+            node = nodes_[node].param_child;
+            continue;
+        }
+
+        size_t next = NONE;
+        for (size_t child : nodes_[node].children) {
+            if (nodes_[child].segment == segment) {
+                next = child;
+                break;
+            }
+        }
+        if (next == NONE) {
+            next = new_node(segment);
+            nodes_[node].children.push_back(next);
+        }
+        node = next;
+    }
+    nodes_[node].target = target;
+}
+
+bool Router::match(HttpMethod method, std::string_view path, Match& match) const {
+    match.target = -1;
+    match.param_count = 0;
+    if (method == HttpMethod::HTTP_OTHER) {
+        return false;
+    }
+    return match_from(roots_[static_cast<size_t>(method)], path, 0, match);
+}
+
+bool Router::match_from(size_t node, std::string_view path, size_t pos, Match& match) const {
+    const Node& current = nodes_[node];
+    if (pos == path.size()) {
+        if (current.target < 0) {
+            return false;
+        }
+        match.target = current.target;
+        return true;
+    }
+    if (path[pos] != '/') {
+        return false;
+    }
+
+    size_t start = pos + 1;
+    size_t end = path.find('/', start);
+    if (end == std::string_view::npos) {
+        end = path.size();
+    }
+    std::string_view segment = path.substr(start, end - start);
+
+    for (size_t child : current.children) {
+        if (nodes_[child].segment == segment && match_from(child, path, end, match)) {
+            return true;
+        }
+    }
+
+    if (current.param_child != NONE && !segment.empty() && match.param_count < MAX_PARAMS) {
+        match.params[match.param_count++] = segment;
+        if (match_from(current.param_child, path, end, match)) {
+            return true;
+        }
+        --match.param_count;
+    }
+
+    if (current.rest_target >= 0 && match.param_count < MAX_PARAMS) {
+        match.params[match.param_count++] = path.substr(start);
+        match.target = current.rest_target;
+        return true;
+    }
+    return false;
+}
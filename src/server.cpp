@@ -1,9 +1,19 @@
 ﻿#include "../include/server.h"
+#include "../include/event_loop.h"
+#include "../include/uring_event_loop.h"
+#include "../include/work_stealing_pool.h"
+#include "../include/connection_pool.h"
+#include "../include/admission_controller.h"
 #include "../include/http_handler.h"
 #include "../include/file_manager.h"
+#include "../include/performance_config.h"
+#include "../include/simd_scan.h"
 #include <iostream>
 #include <cstring>
+#include <cstdio>
 #include <algorithm>
+#include <cctype>
+#include <climits>
 
 #ifdef _WIN32
     // Windows系统 - 使用IOCP
@@ -19,49 +29,279 @@
     #include <sys/socket.h>
     #include <netinet/in.h>
     #include <arpa/inet.h>
+    #include <netinet/tcp.h>
+    #include <sys/sendfile.h>
     #include <fcntl.h>
     #include <errno.h>
-    #define socket_close close
+    #include <sys/eventfd.h>
+    #define socket_close ::close
+    #define SD_SEND SHUT_WR
 #endif
 
+// Semaphore 实现
+Semaphore::Semaphore() {
+#ifdef _WIN32
+    handle_ = CreateSemaphore(nullptr, 0, LONG_MAX, nullptr);
+#else
+    // 信号量语义：每次read只减1，阻塞读用于线程睡眠
+    fd_ = eventfd(0, EFD_SEMAPHORE | EFD_CLOEXEC);
+#endif
+}
+
+Semaphore::~Semaphore() {
+#ifdef _WIN32
+    if (handle_) CloseHandle(handle_);
+#else
+    if (fd_ != -1) ::close(fd_);
+#endif
+}
+
+void Semaphore::post(unsigned count) {
+#ifdef _WIN32
+    ReleaseSemaphore(handle_, static_cast<LONG>(count), nullptr);
+#else
+    uint64_t value = count;
+    if (write(fd_, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+        std::cerr << "信号量唤醒失败，错误码: " << errno << std::endl;
+    }
+#endif
+}
+
+void Semaphore::wait() {
+#ifdef _WIN32
+    WaitForSingleObject(handle_, INFINITE);
+#else
+    uint64_t value;
+    while (read(fd_, &value, sizeof(value)) < 0 && errno == EINTR) {}
+#endif
+}
+
 // TaskQueue 实现
-TaskQueue::TaskQueue(size_t max_size) : max_size_(max_size) {}
+TaskQueue::TaskQueue(size_t max_size)
+    : enqueue_pos_(0), dequeue_pos_(0), sleepers_(0), closed_(false) {
+    size_t capacity = 2;
+    while (capacity < max_size) capacity <<= 1;
+    mask_ = capacity - 1;
+    
+    cells_.reset(new Cell[capacity]);
+    for (size_t i = 0; i < capacity; ++i) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+TaskQueue::~TaskQueue() {}
+
+bool TaskQueue::push(AsyncTask&& task) {
+    if (closed_.load(std::memory_order_relaxed)) return false;
+    
+    Cell* cell;
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+        cell = &cells_[pos & mask_];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // 队列已满
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    
+    cell->task = std::move(task);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    
+    // 与消费者登记睡眠配对的全屏障，保证不会丢失唤醒
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) > 0) {
+        wakeup_.post();
+    }
+    return true;
+}
 
-void TaskQueue::push(AsyncTask task) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (tasks_.size() < max_size_) {
-        tasks_.push(std::move(task));
-        not_empty_.notify_one();
+bool TaskQueue::try_pop(AsyncTask& task) {
+    Cell* cell;
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+        cell = &cells_[pos & mask_];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // 队列为空
+        } else {
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
     }
+    
+    task = std::move(cell->task);
+    cell->task = AsyncTask();
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
 }
 
 bool TaskQueue::pop(AsyncTask& task) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    not_empty_.wait(lock, [this] { return !tasks_.empty(); });
-    
-    if (!tasks_.empty()) {
-        task = std::move(tasks_.front());
-        tasks_.pop();
-        return true;
+    while (!closed_.load(std::memory_order_acquire)) {
+        if (try_pop(task)) return true;
+        
+        // 先登记为睡眠者再检查一次，与push中的屏障配对
+        sleepers_.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (try_pop(task)) {
+            sleepers_.fetch_sub(1);
+            return true;
+        }
+        if (!closed_.load(std::memory_order_acquire)) {
+            wakeup_.wait();
+        }
+        sleepers_.fetch_sub(1);
     }
     return false;
 }
 
+void TaskQueue::shutdown() {
+    closed_.store(true, std::memory_order_release);
+    // 信号量计数足够大，当前和之后的等待都会立即返回
+    wakeup_.post(1u << 30);
+}
+
 bool TaskQueue::empty() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return tasks_.empty();
+    return size() == 0;
 }
 
 size_t TaskQueue::size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return tasks_.size();
+    size_t enqueued = enqueue_pos_.load(std::memory_order_acquire);
+    size_t dequeued = dequeue_pos_.load(std::memory_order_acquire);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+}
+
+// 根据路由结果判断任务类型
+static TaskType classify_endpoint(Endpoint endpoint) {
+    switch (endpoint) {
+        case Endpoint::UPLOAD:
+        case Endpoint::PUT_FILE:
+            return TaskType::FILE_UPLOAD;
+        case Endpoint::DOWNLOAD_FILE:
+            return TaskType::FILE_DOWNLOAD;
+        case Endpoint::DELETE_FILE:
+            return TaskType::FILE_DELETE;
+        default:
+            return TaskType::READ_REQUEST;
+    }
+}
+
+// Content-Length只接受十进制数字，拒绝空值、符号和溢出
+static bool parse_content_length(std::string_view value, uint64_t& length) {
+    if (value.empty()) return false;
+    length = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') return false;
+        uint64_t digit = static_cast<uint64_t>(c - '0');
+        if (length > (UINT64_MAX - digit) / 10) return false;
+        length = length * 10 + digit;
+    }
+    return true;
+}
+
+// 没有对应处理的请求返回404/405，否则返回0
+static int route_status(Endpoint endpoint) {
+    switch (endpoint) {
+        case Endpoint::NOT_FOUND:
+            return 404;
+        case Endpoint::METHOD_NOT_ALLOWED:
+            return 405;
+        default:
+            return 0;
+    }
+}
+
+// 不区分大小写查找子串，不复制头部值
+static bool contains_ignore_case(std::string_view text, std::string_view token) {
+    for (size_t i = 0; i + token.size() <= text.size(); ++i) {
+        if (HeaderMap::equals_ignore_case(text.substr(i, token.size()), token)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 根据协议版本和Connection头判断客户端是否希望保持连接，直接使用解析器中的视图
+static bool request_wants_keep_alive(const RequestParser& parser) {
+#ifdef _WIN32
+    // Windows下请求在接受线程中同步读取，保持连接会阻塞后续accept
+    (void)parser;
+    return false;
+#else
+    std::string_view connection;
+    parser.find_header("Connection", connection);
+    
+    // HTTP/1.1默认保持连接，HTTP/1.0需要显式的keep-alive
+    if (parser.version() == "HTTP/1.1") {
+        return !contains_ignore_case(connection, "close");
+    }
+    return contains_ignore_case(connection, "keep-alive");
+#endif
 }
 
 // Connection 实现
 Connection::Connection(socket_t socket, const std::string& client_ip) 
-    : socket_(socket), client_ip_(client_ip), state_(ConnectionState::CONNECTING) {
+    : socket_(INVALID_SOCKET) {
+    reset(socket, client_ip);
+}
+
+Connection::~Connection() {
+    if (socket_ != INVALID_SOCKET) {
+        socket_close(socket_);
+    }
+}
+
+void Connection::reset(socket_t socket, const std::string& client_ip) {
+    socket_ = socket;
+    handle_ = ~uint64_t(0);
+    client_ip_ = client_ip;
+    state_ = ConnectionState::CONNECTING;
+    keep_alive_ = false;
+    requests_served_ = 0;
+    routed_ = false;
+    route_ = HttpHandler::Route{Endpoint::NOT_FOUND, nullptr, std::string()};
+    request_route_ = route_;
+    admission_ = nullptr;
+    admission_checked_ = false;
+    holds_admission_ = false;
+    shed_ = false;
+    shed_status_ = 0;
+    send_throttled_ = false;
+    corked_ = false;
+    body_sink_.reset();
+    body_remaining_ = 0;
+    body_start_ = 0;
+    body_checked_ = false;
+    headers_checked_ = false;
+    content_length_ = 0;
+    has_content_length_ = false;
+    body_chunks_.clear();
+    body_pending_bytes_ = 0;
+    body_received_ = 0;
+    body_task_bytes_ = 0;
+    body_task_running_ = false;
+    body_opening_ = false;
+    body_splice_ = false;
+    expect_continue_ = false;
+    opened_sink_.reset();
+    read_buffer_.clear();
+    write_buffer_.clear();
+    request_buffer_.clear();
+    parser_.reset();
+    request_parser_.reset();
     
     last_activity_ = std::chrono::steady_clock::now();
+    request_start_ = last_activity_;
     
 #ifdef _WIN32
     // 初始化Windows异步I/O结构
@@ -80,14 +320,34 @@ Connection::Connection(socket_t socket, const std::string& client_ip)
 #endif
 }
 
-Connection::~Connection() {
+// 清空缓冲区；容量超过上限的（例如大上传留下的）直接释放，避免池中对象长期占用内存
+static void recycle_buffer(std::string& buffer) {
+    if (buffer.capacity() > PerformanceConfig::CONNECTION_POOL_MAX_BUFFER) {
+        std::string().swap(buffer);
+    } else {
+        buffer.clear();
+    }
+}
+
+void Connection::recycle() {
     if (socket_ != INVALID_SOCKET) {
         socket_close(socket_);
+        socket_ = INVALID_SOCKET;
     }
+    state_ = ConnectionState::CLOSED;
+    dispatcher_ = nullptr;  // 回调捕获了事件循环，不能跨连接保留
+    body_task_runner_ = nullptr;
+    release_admission();    // 请求未完成就断开的连接也要归还名额
+    body_sink_.reset();     // 未接收完的上传文件随之删除
+    opened_sink_.reset();
+    
+    recycle_buffer(read_buffer_);
+    write_buffer_.clear();  // 内存段归还段池
+    recycle_buffer(request_buffer_);
 }
 
 void Connection::set_state(ConnectionState state) {
-    state_ = state;
+    state_.store(state, std::memory_order_release);
     update_activity();
 }
 
@@ -95,7 +355,7 @@ void Connection::async_read() {
     if (state_ == ConnectionState::CLOSED) return;
     
     set_state(ConnectionState::READING);
-    std::cout << "开始读取，连接状态: " << static_cast<int>(state_) << std::endl;
+    std::cout << "开始读取，连接状态: " << static_cast<int>(get_state()) << std::endl;
     
 #ifdef _WIN32
     // 先读取头部，确定 Content-Length
@@ -103,14 +363,20 @@ void Connection::async_read() {
     std::vector<char> temp_buffer(Server::BUFFER_SIZE);
     
     // 循环读取直到找到头部结束标记
+    size_t header_end = std::string::npos;
+    size_t scanned = 0;
     while (true) {
-        DWORD bytes_received = recv(socket_, temp_buffer.data(), temp_buffer.size(), 0);
+        int bytes_received = recv(socket_, temp_buffer.data(), static_cast<int>(temp_buffer.size()), 0);
         
         if (bytes_received > 0) {
             full_request.append(temp_buffer.data(), bytes_received);
             
-            // 检查是否找到了头部结束标记
-            if (full_request.find("\r\n\r\n") != std::string::npos) {
+            // 只扫描新到达的数据，往前多取3字节，结束标记跨两次接收时也能找到
+            size_t from = scanned >= 3 ? scanned - 3 : 0;
+            size_t found = SimdScan::find_header_end(full_request.data() + from, full_request.size() - from);
+            scanned = full_request.size();
+            if (from + found < full_request.size()) {
+                header_end = from + found;
                 break;  // 头部读取完成
             }
         } else if (bytes_received == 0) {
@@ -126,7 +392,6 @@ void Connection::async_read() {
     }
     
     // 解析头部，获取 Content-Length
-    size_t header_end = full_request.find("\r\n\r\n");
     std::string headers_text = full_request.substr(0, header_end);
     
     // 查找 Content-Length
@@ -141,21 +406,30 @@ void Connection::async_read() {
         content_length_str.erase(0, content_length_str.find_first_not_of(" \t"));
         content_length_str.erase(content_length_str.find_last_not_of(" \t") + 1);
         
-        int expected_content_length = std::stoi(content_length_str);
-        std::cout << "预期 Content-Length: " << expected_content_length << " 字节" << std::endl;
-        
-        // 继续读取剩余的数据
-        int remaining_bytes = expected_content_length - (full_request.length() - header_end - 4);
+        // 头部到齐：准入检查和头部检查（长度无效或超过上传上限等直接拒绝），
+        // 流式接收的请求从这里开始把body交给body_sink_
+        read_buffer_.assign(full_request.begin(), full_request.end());
+        request_ready();
         
-        if (remaining_bytes > 0) {
-            std::cout << "需要继续读取 " << remaining_bytes << " 字节" << std::endl;
+        uint64_t expected_content_length = 0;
+        if (!shed_ && parse_content_length(content_length_str, expected_content_length)) {
+            std::cout << "预期 Content-Length: " << expected_content_length << " 字节" << std::endl;
+            
+            // 继续读取剩余的数据
+            uint64_t received_body = full_request.length() - header_end - 4;
+            uint64_t remaining_bytes = expected_content_length > received_body ? expected_content_length - received_body : 0;
+            
+            if (remaining_bytes > 0) {
+                std::cout << "需要继续读取 " << remaining_bytes << " 字节" << std::endl;
+            }
             
             while (remaining_bytes > 0) {
-                int bytes_to_read = (remaining_bytes < (int)temp_buffer.size()) ? remaining_bytes : (int)temp_buffer.size();
-                DWORD bytes_received = recv(socket_, temp_buffer.data(), bytes_to_read, 0);
+                int bytes_to_read = static_cast<int>((std::min)(remaining_bytes, static_cast<uint64_t>(temp_buffer.size())));
+                int bytes_received = recv(socket_, temp_buffer.data(), bytes_to_read, 0);
                 
                 if (bytes_received > 0) {
-                    full_request.append(temp_buffer.data(), bytes_received);
+                    read_buffer_.append(temp_buffer.data(), bytes_received);
+                    request_ready();
                     remaining_bytes -= bytes_received;
                     std::cout << "继续读取 " << bytes_received << " 字节，剩余 " << remaining_bytes << " 字节" << std::endl;
                 } else if (bytes_received == 0) {
@@ -171,53 +445,423 @@ void Connection::async_read() {
             }
         }
         
-        std::cout << "完整读取完成，总数据长度: " << full_request.length() << " 字节" << std::endl;
-        read_buffer_.assign(full_request.begin(), full_request.end());
-        handle_read_completion(full_request.length());
+        std::cout << "完整读取完成，缓冲数据长度: " << read_buffer_.size() << " 字节" << std::endl;
+        handle_read_completion(read_buffer_.size());
         
     } else {
         std::cout << "未找到 Content-Length，使用已读取的数据" << std::endl;
         read_buffer_.assign(full_request.begin(), full_request.end());
+        request_ready();
         handle_read_completion(full_request.length());
     }
     
 #else
-    // Linux epoll非阻塞读取
-    read_buffer_.resize(Server::BUFFER_SIZE);
-    ssize_t bytes_received = recv(socket_, &read_buffer_[0], read_buffer_.size(), 0);
-    
-    if (bytes_received > 0) {
-        read_buffer_.resize(bytes_received);
-        handle_read_completion(bytes_received);
-    } else if (bytes_received == 0) {
-        set_state(ConnectionState::CLOSING);
-    } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+    // Linux epoll边缘触发读取：必须一直读到EAGAIN，已读数据保留在read_buffer_中跨事件累积
+    size_t total_received = 0;
+    bool new_request = read_buffer_.empty();
+    while (true) {
+        // 磁盘写入跟不上时暂停读取，写入任务完成后由事件循环恢复
+        if (is_read_paused()) break;
+        
+        // 流式接收且缓冲区中没有待处理的body时，支持的BodySink直接从socket接收：数据splice进管道，
+        // 不经过用户态，本轮读取结束后由磁盘通道从管道写入文件
+        if (body_sink_ && body_splice_ && body_remaining_ > 0 && read_buffer_.size() == body_start_) {
+            // 上一批还在写入时不读取，BodySink同一时刻只由一个线程访问
+            if (body_task_running_ || !body_chunks_.empty()) break;
+            
+            long long moved = body_sink_->receive_from(socket_, body_remaining_);
+            if (moved > 0) {
+                body_remaining_ -= static_cast<uint64_t>(moved);
+                body_received_ += static_cast<uint64_t>(moved);
+                body_pending_bytes_ += static_cast<uint64_t>(moved);
+                total_received += static_cast<size_t>(moved);
+                continue;
+            }
+            if (moved == 0) {
+                set_state(ConnectionState::CLOSING);
+                return;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            if (errno != ENOSYS) {
+                set_state(ConnectionState::CLOSING);
+                return;
+            }
+            // 不支持直接接收，改用recv
+            body_splice_ = false;
+        }
+        
+        size_t old_size = read_buffer_.size();
+        read_buffer_.resize(old_size + Server::BUFFER_SIZE);
+        ssize_t bytes_received = recv(socket_, &read_buffer_[old_size], Server::BUFFER_SIZE, 0);
+        
+        if (bytes_received > 0) {
+            read_buffer_.resize(old_size + bytes_received);
+            total_received += bytes_received;
+            // 流式接收的body每读一块就交给body_sink_，读取缓冲区不随上传大小增长；
+            // 请求被拒绝后不再继续读取
+            request_ready();
+            if (shed_) break;
+            continue;
+        }
+        
+        read_buffer_.resize(old_size);
+        if (bytes_received == 0) {
+            set_state(ConnectionState::CLOSING);
+            return;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
         set_state(ConnectionState::CLOSING);
+        return;
+    }
+    
+    // 本轮splice进管道的数据交给磁盘通道
+    submit_body_chunks();
+    
+    if (new_request && total_received > 0) {
+        request_start_ = std::chrono::steady_clock::now();
+    }
+    
+    // 请求尚未完整（头部或body未收齐），等待下一次可读事件
+    if (total_received > 0 && request_ready()) {
+        handle_read_completion(read_buffer_.size());
     }
 #endif
 }
 
-void Connection::async_write(const std::string& data) {
+bool Connection::request_complete() const {
+    return buffered_request_length() > 0;
+}
+
+void Connection::send_continue() {
+    // 中间响应只有一行，此时上一个响应已发送完，发送缓冲区是空的，非阻塞发送即可；失败时客户端超时后也会发送body
+    static const char CONTINUE_RESPONSE[] = "HTTP/1.1 100 Continue\r\n\r\n";
+#ifdef _WIN32
+    send(socket_, CONTINUE_RESPONSE, sizeof(CONTINUE_RESPONSE) - 1, 0);
+#else
+    send(socket_, CONTINUE_RESPONSE, sizeof(CONTINUE_RESPONSE) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+#endif
+    std::cout << "已发送 100 Continue" << std::endl;
+}
+
+bool Connection::request_ready() {
+    // 只扫描新到达的数据；头部收齐前不做任何检查
+    if (parser_.parse(read_buffer_) == RequestParser::Status::INCOMPLETE) {
+        return false;
+    }
+    // 先检查头部再做准入：注定被拒绝的请求（400/411/413/417/501等）不消耗客户端的请求令牌和并发名额，
+    // 并且回复真实的错误而不是429/503
+    route_request();
+    check_headers();
+    admit_request();
+    if (!shed_) {
+        stream_body();
+    }
+    return shed_ || request_complete();
+}
+
+void Connection::check_headers() {
+    if (headers_checked_) return;
+    headers_checked_ = true;
+    
+    // 头部到齐即决定是否接收body：格式错误、长度无效、超过上传上限或没有对应处理的请求直接回复错误，
+    // 不再读取body；等待100 Continue的客户端因此根本不会发送body
+    std::string_view content_length_value;
+    std::string_view expectation;
+    std::string_view transfer_encoding;
+    has_content_length_ = parser_.find_header("Content-Length", content_length_value);
+    bool has_expectation = parser_.find_header("Expect", expectation);
+    content_length_ = 0;
+    int status = 0;
+    if (parser_.status() == RequestParser::Status::INVALID) {
+        status = 400;
+    } else if (parser_.find_header("Transfer-Encoding", transfer_encoding)) {
+        // 不支持分块等传输编码：body边界无法确定，若按Content-Length或无body处理，
+        // 剩余的数据会被当作下一个请求解析
+        status = has_content_length_ ? 501 : 411;
+    } else if (has_content_length_ && !parse_content_length(content_length_value, content_length_)) {
+        status = 400;
+    } else if (content_length_ > PerformanceConfig::MAX_UPLOAD_SIZE) {
+        status = 413;
+    }
+    
+    expect_continue_ = false;
+    if (status == 0 && has_expectation) {
+        if (HeaderMap::equals_ignore_case(expectation, "100-continue")) {
+            expect_continue_ = true;
+        } else {
+            status = 417;
+        }
+    }
+    
+    if (status == 0 && (content_length_ > 0 || expect_continue_)) {
+        status = route_status(route_.endpoint);
+    }
+    
+    if (status != 0) {
+        std::cout << "请求头部检查未通过，直接回复 " << status << "，不接收body" << std::endl;
+        shed_ = true;
+        shed_status_ = status;
+    }
+}
+
+void Connection::stream_body() {
+    if (!body_checked_) {
+        body_checked_ = true;
+        
+        // 客户端在等待确认且body尚未开始到达时回复100 Continue；流式接收的请求等BodySink创建好再回复，
+        // 创建失败时仍按普通请求接收body
+        size_t header_length = parser_.header_length();
+        expect_continue_ = expect_continue_ && content_length_ > 0 && read_buffer_.size() == header_length;
+        
+        Endpoint endpoint = route_.endpoint;
+        if (!has_content_length_ || (endpoint != Endpoint::UPLOAD && endpoint != Endpoint::PUT_FILE)) {
+            if (expect_continue_) send_continue();
+            return;
+        }
+        
+        // 创建BodySink会访问文件系统（PUT检查目标文件并创建临时文件），在磁盘通道进行，期间暂停读取
+        body_start_ = header_length;
+        auto request = std::make_shared<HttpRequest>(
+            HttpHandler::make_request(parser_, std::string_view(read_buffer_.data(), header_length)));
+        request->name = route_.name;
+        body_opening_ = true;
+        start_body_task(0, [this, endpoint, request]() {
+            HttpHandler http_handler;
+            opened_sink_ = http_handler.create_body_sink(endpoint, *request);
+        });
+    }
+    
+    if (!body_sink_ || body_remaining_ == 0 || read_buffer_.size() <= body_start_) return;
+    
+    // body移入待写队列后立即从读取缓冲区移除；其后可能是流水线中的下一个请求，保留
+    size_t length = static_cast<size_t>((std::min)(
+        static_cast<uint64_t>(read_buffer_.size() - body_start_), body_remaining_));
+    body_chunks_.emplace_back(read_buffer_, body_start_, length);
+    read_buffer_.erase(body_start_, length);
+    body_remaining_ -= length;
+    body_pending_bytes_ += length;
+    submit_body_chunks();
+}
+
+void Connection::submit_body_chunks() {
+    if (body_task_running_ || (body_chunks_.empty() && body_received_ == 0)) return;
+    
+    uint64_t bytes = body_received_;
+    for (const std::string& chunk : body_chunks_) {
+        bytes += chunk.size();
+    }
+    
+    auto chunks = std::make_shared<std::vector<std::string>>();
+    chunks->swap(body_chunks_);
+    uint64_t received = body_received_;
+    body_received_ = 0;
+    BodySink* sink = body_sink_.get();
+    // 只有没有排队数据时才会splice进管道，管道中的数据总是先到达
+    start_body_task(bytes, [sink, received, chunks]() {
+        if (received > 0) {
+            sink->write_received(received);
+        }
+        for (const std::string& chunk : *chunks) {
+            sink->write(chunk.data(), chunk.size());
+        }
+    });
+}
+
+void Connection::start_body_task(uint64_t bytes, std::function<void()> work) {
+    body_task_running_ = true;
+    body_task_bytes_ = bytes;
+    
+    // 没有磁盘通道（Windows同步读取路径）时直接执行
+    if (!body_task_runner_) {
+        work();
+        complete_body_task();
+        return;
+    }
+    
+    if (!body_task_runner_(shared_from_this(), std::move(work))) {
+        // 磁盘通道队列已满，上传无法继续，按过载拒绝
+        std::cout << "磁盘通道队列已满，放弃接收body" << std::endl;
+        body_task_running_ = false;
+        body_task_bytes_ = 0;
+        body_opening_ = false;
+        shed_ = true;
+        shed_status_ = 503;
+    }
+}
+
+void Connection::complete_body_task() {
+    body_task_running_ = false;
+    body_pending_bytes_ -= body_task_bytes_;
+    body_task_bytes_ = 0;
+    
+    if (body_opening_) {
+        body_opening_ = false;
+        body_sink_ = std::move(opened_sink_);
+        if (body_sink_) {
+            body_remaining_ = content_length_;
+            body_splice_ = true;
+            std::cout << "流式接收请求body，共 " << body_remaining_ << " 字节" << std::endl;
+        }
+        if (expect_continue_ && read_buffer_.size() == body_start_) {
+            send_continue();
+        }
+    }
+}
+
+void Connection::on_body_task_done() {
+    complete_body_task();
+    update_activity();
+    if (get_state() != ConnectionState::READING) return;
+    
+    // 继续写入任务执行期间排队的数据；最后一块写完时请求才算完整
+    submit_body_chunks();
+    if (request_ready()) {
+        handle_read_completion(read_buffer_.size());
+    }
+}
+
+bool Connection::is_read_paused() const {
+    return body_opening_ || body_pending_bytes_ >= PerformanceConfig::UPLOAD_MAX_PENDING_BYTES;
+}
+
+void Connection::route_request() {
+    if (routed_) return;
+    routed_ = true;
+    route_ = HttpHandler::route(parser_.method(), parser_.path());
+}
+
+void Connection::admit_request() {
+    // 头部检查未通过的请求已确定回复的错误，不再做准入
+    if (admission_checked_ || !admission_ || shed_) return;
+    
+    // 头部到齐后立即检查，被拒绝的请求不必等待body
+    if (parser_.status() == RequestParser::Status::INCOMPLETE) return;
+    
+    admission_checked_ = true;
+    if (!admission_->rate_limiter().allow_request(client_ip_)) {
+        shed_ = true;
+        shed_status_ = 429;
+        return;
+    }
+    
+    TaskType type = classify_endpoint(route_.endpoint);
+    if (admission_->try_acquire(type)) {
+        admitted_type_ = type;
+        holds_admission_ = true;
+    } else {
+        shed_ = true;
+        shed_status_ = 503;
+    }
+}
+
+size_t Connection::acquire_send_quota(size_t wanted) {
+    size_t quota = admission_ ? admission_->rate_limiter().acquire_bytes(client_ip_, wanted) : wanted;
+    send_throttled_ = quota == 0 && wanted > 0;
+    return quota;
+}
+
+void Connection::refund_send_quota(size_t unused) {
+    if (admission_) {
+        admission_->rate_limiter().refund_bytes(client_ip_, unused);
+    }
+}
+
+void Connection::set_cork(bool enabled) {
+#ifndef _WIN32
+    if (corked_ == enabled || socket_ == INVALID_SOCKET) return;
+    int value = enabled ? 1 : 0;
+    setsockopt(socket_, IPPROTO_TCP, TCP_CORK, &value, sizeof(value));
+    corked_ = enabled;
+#else
+    (void)enabled;
+#endif
+}
+
+void Connection::release_admission() {
+    if (holds_admission_) {
+        admission_->release(admitted_type_);
+        holds_admission_ = false;
+    }
+    admission_checked_ = false;
+}
+
+size_t Connection::buffered_request_length() const {
+    // 头部检查之后才知道body长度；BodySink创建好之前body留在读取缓冲区，不算完整
+    if (!body_checked_ || body_opening_) {
+        return 0;
+    }
+    
+    // 流式接收时body不在缓冲区中，body收齐并全部写入后请求只剩头部
+    if (body_sink_) {
+        return body_remaining_ == 0 && body_pending_bytes_ == 0 ? body_start_ : 0;
+    }
+    
+    uint64_t request_length = parser_.header_length() + content_length_;
+    return read_buffer_.size() >= request_length ? static_cast<size_t>(request_length) : 0;
+}
+
+void Connection::async_write(ResponseBuffer data) {
     if (state_ == ConnectionState::CLOSED) return;
     
-    set_state(ConnectionState::WRITING);
-    write_buffer_ = data;
-    std::cout << "开始发送响应，数据长度: " << data.length() << " 字节" << std::endl;
+    begin_write(std::move(data));
     
 #ifdef _WIN32
-    // 使用同步发送确保数据完全发送
-    const char* buffer = data.data();
-    size_t total_sent = 0;
-    size_t remaining = data.length();
+    // 使用同步发送确保数据完全发送，头部和body一次WSASend发出
+    uint64_t length = write_buffer_.size();
+    uint64_t total_sent = 0;
+    std::vector<char> file_chunk;
     
-    while (remaining > 0) {
-        int bytes_sent = send(socket_, buffer + total_sent, static_cast<int>(remaining), 0);
+    while (pending_write_bytes() > 0) {
+        size_t quota = acquire_send_quota(static_cast<size_t>(
+            (std::min)(pending_write_bytes(), static_cast<uint64_t>(SIZE_MAX))));
+        if (quota == 0) {
+            // 同步发送路径没有事件循环重试，等待令牌补充
+            std::this_thread::sleep_for(std::chrono::milliseconds(PerformanceConfig::TIMER_WHEEL_TICK_MS));
+            continue;
+        }
         
-        if (bytes_sent > 0) {
+        DWORD bytes_sent = 0;
+        int result;
+        uint64_t file_offset = 0;
+        uint64_t file_length = 0;
+        const FileBody* file = write_buffer_.front_file(file_offset, file_length);
+        if (file) {
+            // Windows没有sendfile，文件内容分块读入临时缓冲区再发送
+            if (file_chunk.empty()) file_chunk.resize(Server::BUFFER_SIZE);
+            size_t chunk = static_cast<size_t>((std::min)(
+                static_cast<uint64_t>((std::min)(quota, file_chunk.size())), file_length));
+            long long bytes_read = file->read(file_offset, file_chunk.data(), chunk);
+            if (bytes_read <= 0) {
+                std::cerr << "读取文件失败，停止发送" << std::endl;
+                refund_send_quota(quota);
+                break;
+            }
+            WSABUF buffer;
+            buffer.buf = file_chunk.data();
+            buffer.len = static_cast<ULONG>(bytes_read);
+            result = WSASend(socket_, &buffer, 1, &bytes_sent, 0, nullptr, nullptr);
+        } else {
+            WSABUF buffers[OutputBuffer::MAX_IOVECS];
+            DWORD count = static_cast<DWORD>(fill_write_buffers(buffers, quota));
+            result = WSASend(socket_, buffers, count, &bytes_sent, 0, nullptr, nullptr);
+        }
+        refund_send_quota(result == 0 ? quota - bytes_sent : quota);
+        
+        if (result == 0 && bytes_sent > 0) {
+            write_buffer_.consume(bytes_sent);
             total_sent += bytes_sent;
-            remaining -= bytes_sent;
-            std::cout << "已发送 " << total_sent << "/" << data.length() << " 字节" << std::endl;
-        } else if (bytes_sent == 0) {
+            std::cout << "已发送 " << total_sent << "/" << length << " 字节" << std::endl;
+        } else if (result == 0) {
             std::cout << "连接关闭，无法发送更多数据" << std::endl;
             break;
         } else {
@@ -227,32 +871,135 @@ void Connection::async_write(const std::string& data) {
         }
     }
     
-    if (total_sent == data.length()) {
+    if (total_sent == length) {
         std::cout << "响应完全发送成功！" << std::endl;
-        
-        // 等待数据完全发送到网络
-        std::cout << "等待数据发送到网络..." << std::endl;
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        
-        handle_write_completion(total_sent);
+        handle_write_completion(static_cast<size_t>(total_sent));
     } else {
-        std::cout << "响应发送不完整，已发送 " << total_sent << "/" << data.length() << " 字节" << std::endl;
+        std::cout << "响应发送不完整，已发送 " << total_sent << "/" << length << " 字节" << std::endl;
         set_state(ConnectionState::CLOSING);
     }
 #else
-    // Linux epoll非阻塞写入
-    ssize_t bytes_sent = send(socket_, write_buffer_.data(), write_buffer_.length(), 0);
+    // Linux epoll非阻塞写入，未发送完的部分等待EPOLLOUT后由continue_write继续
+    continue_write();
+#endif
+}
+
+void Connection::begin_write(ResponseBuffer data) {
+    set_state(ConnectionState::WRITING);
+    std::cout << "开始发送响应，头部 " << data.head.size() << " 字节，body "
+              << data.size() - data.head.size() << " 字节" << std::endl;
+    // 头部和小body拷贝进同一个内存段，大body直接接管
+    write_buffer_.append(data.head.data(), data.head.size());
+    write_buffer_.append(std::move(data.body));
     
-    if (bytes_sent > 0) {
-        write_buffer_.erase(0, bytes_sent);
-        if (write_buffer_.empty()) {
-            set_state(ConnectionState::READING);
+    // 文件内容不读入内存，发送到文件节点时用sendfile；头部和文件开头凑成满报文再发出
+    bool has_file = false;
+    for (FileRange& range : data.file_ranges) {
+        write_buffer_.append(std::move(range.prefix));
+        if (data.file && range.length > 0) {
+            write_buffer_.append_file(data.file, range.offset, range.length);
+            has_file = true;
         }
-    } else if (bytes_sent == 0) {
-        set_state(ConnectionState::CLOSING);
-    } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
-        set_state(ConnectionState::CLOSING);
     }
+    write_buffer_.append(std::move(data.trailer));
+    if (has_file) {
+        set_cork(true);
+    }
+}
+
+void Connection::on_data_received(const char* data, size_t length) {
+    if (state_ == ConnectionState::CLOSING || state_ == ConnectionState::CLOSED) return;
+    if (shed_) return;  // 已拒绝的请求剩余的body直接丢弃
+    
+    // 处理或发送响应期间收到的流水线请求先缓存，响应发送完后再处理
+    if (read_buffer_.empty()) {
+        request_start_ = std::chrono::steady_clock::now();
+    }
+    read_buffer_.append(data, length);
+    update_activity();
+    if (state_ != ConnectionState::CONNECTING && state_ != ConnectionState::READING) return;
+    
+    set_state(ConnectionState::READING);
+    if (request_ready()) {
+        handle_read_completion(read_buffer_.size());
+    }
+}
+
+void Connection::on_data_sent(size_t bytes_sent) {
+    if (state_ != ConnectionState::WRITING) return;
+    
+    write_buffer_.consume(bytes_sent);
+    if (pending_write_bytes() == 0) {
+        handle_write_completion(bytes_sent);
+    } else {
+        update_activity();
+    }
+}
+
+#ifdef _WIN32
+size_t Connection::fill_write_buffers(WSABUF* buffers, size_t max_bytes) const {
+#else
+size_t Connection::fill_write_buffers(struct iovec* buffers, size_t max_bytes) const {
+#endif
+    return write_buffer_.fill(buffers, OutputBuffer::MAX_IOVECS, max_bytes);
+}
+
+void Connection::continue_write() {
+#ifndef _WIN32
+    if (state_ != ConnectionState::WRITING) return;
+    
+    size_t total_sent = 0;
+    while (pending_write_bytes() > 0) {
+        size_t quota = acquire_send_quota(static_cast<size_t>(
+            std::min<uint64_t>(pending_write_bytes(), SSIZE_MAX)));
+        if (quota == 0) {
+            // 令牌不足，由事件循环在下一个tick重试
+            if (total_sent > 0) update_activity();
+            return;
+        }
+        
+        ssize_t bytes_sent;
+        uint64_t file_offset = 0;
+        uint64_t file_length = 0;
+        const FileBody* file = write_buffer_.front_file(file_offset, file_length);
+        if (file) {
+            // 文件节点由内核直接从页缓存发送，不经过用户态缓冲区
+            off_t offset = static_cast<off_t>(file_offset);
+            size_t count = static_cast<size_t>(std::min<uint64_t>(quota, file_length));
+            bytes_sent = sendfile(socket_, file->fd(), &offset, count);
+            if (bytes_sent == 0) {
+                // 文件在发送过程中被截断，已声明的Content-Length无法满足，只能断开
+                std::cerr << "文件在发送过程中被截断，关闭连接" << std::endl;
+                refund_send_quota(quota);
+                set_state(ConnectionState::CLOSING);
+                return;
+            }
+        } else {
+            // 输出缓冲区的各个节点作为iovec一次发出（sendmsg相当于带MSG_NOSIGNAL的writev）
+            struct iovec buffers[OutputBuffer::MAX_IOVECS];
+            struct msghdr message = {};
+            message.msg_iov = buffers;
+            message.msg_iovlen = fill_write_buffers(buffers, quota);
+            bytes_sent = sendmsg(socket_, &message, MSG_NOSIGNAL);
+        }
+        refund_send_quota(bytes_sent > 0 ? quota - bytes_sent : quota);
+        
+        if (bytes_sent > 0) {
+            write_buffer_.consume(bytes_sent);
+            total_sent += bytes_sent;
+        } else if (bytes_sent < 0 && errno == EINTR) {
+            continue;
+        } else if (bytes_sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // 内核发送缓冲区已满，等待下一次可写事件
+            if (total_sent > 0) update_activity();
+            return;
+        } else {
+            set_state(ConnectionState::CLOSING);
+            return;
+        }
+    }
+    
+    handle_write_completion(total_sent);
 #endif
 }
 
@@ -260,10 +1007,48 @@ void Connection::async_close() {
     set_state(ConnectionState::CLOSING);
 }
 
+void Connection::close() {
+    if (socket_ != INVALID_SOCKET) {
+        socket_close(socket_);
+        socket_ = INVALID_SOCKET;
+    }
+    set_state(ConnectionState::CLOSED);
+}
+
+std::chrono::steady_clock::time_point Connection::deadline() const {
+    using std::chrono::milliseconds;
+    
+    switch (state_) {
+    case ConnectionState::PROCESSING:
+        // 正在由工作线程处理的请求不计入超时
+        return std::chrono::steady_clock::time_point::max();
+        
+    case ConnectionState::CONNECTING:
+    case ConnectionState::READING:
+        if (read_buffer_.empty()) {
+            // 等待请求：首个请求前使用连接超时，持久连接在请求之间使用保活超时
+            int idle_ms = requests_served_ > 0 ? PerformanceConfig::KEEP_ALIVE_TIMEOUT_MS
+                                               : PerformanceConfig::CONNECTION_TIMEOUT_MS;
+            return last_activity_ + milliseconds(idle_ms);
+        }
+        if (parser_.status() == RequestParser::Status::INCOMPLETE) {
+            // 读取头部：从请求第一个字节开始计时，零散到达的数据不会延长期限
+            return request_start_ + milliseconds(PerformanceConfig::CONNECTION_TIMEOUT_MS);
+        }
+        // 读取body：大文件上传按数据到达的进度计时
+        return last_activity_ + milliseconds(PerformanceConfig::REQUEST_TIMEOUT_MS);
+        
+    case ConnectionState::CLOSING:
+    case ConnectionState::CLOSED:
+        return last_activity_;
+        
+    default:
+        return last_activity_ + milliseconds(PerformanceConfig::CONNECTION_TIMEOUT_MS);
+    }
+}
+
 bool Connection::is_expired() const {
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_activity_);
-    return elapsed.count() > Server::CONNECTION_TIMEOUT_MS;
+    return std::chrono::steady_clock::now() >= deadline();
 }
 
 void Connection::update_activity() {
@@ -272,118 +1057,204 @@ void Connection::update_activity() {
 
 void Connection::handle_read_completion(size_t bytes_read) {
     if (bytes_read > 0) {
-        read_buffer_.resize(bytes_read);
-        update_activity();
-        
-        std::cout << "收到 " << bytes_read << " 字节数据" << std::endl;
-        
-        // 解析HTTP请求
-        std::string request_data(read_buffer_.begin(), read_buffer_.end());
-        std::cout << "HTTP请求数据: " << request_data.substr(0, 100) << "..." << std::endl;
-        
-        HttpHandler http_handler;
-        HttpRequest request = http_handler.parse_request(request_data);
-        
-        std::cout << "解析的请求: " << request.method << " " << request.path << std::endl;
-        
-        // 处理HTTP请求
-        HttpResponse response;
-        if (request.method == "GET") {
-            if (request.path == "/files") {
-                std::cout << "处理文件列表请求" << std::endl;
-                response = http_handler.handle_list_files(request);
-            } else if (request.path.substr(0, 10) == "/download/") {
-                std::cout << "处理文件下载请求: " << request.path << std::endl;
-                response = http_handler.handle_download(request);
-            } else if (request.path == "/stats") {
-                std::cout << "处理性能统计请求" << std::endl;
-                // 返回性能统计信息
-                response.status_code = 200;
-                response.status_text = "OK";
-                response.headers["Content-Type"] = "application/json";
-                response.body = "{\"status\":\"success\",\"message\":\"性能统计信息\"}";
-            } else {
-                std::cout << "404 Not Found: " << request.path << std::endl;
-                response.status_code = 404;
-                response.status_text = "Not Found";
-                response.headers["Content-Type"] = "text/plain";
-                response.body = "404 Not Found";
-            }
-        } else if (request.method == "POST") {
-            if (request.path == "/upload") {
-                std::cout << "处理文件上传请求" << std::endl;
-                response = http_handler.handle_upload(request);
-            } else {
-                std::cout << "404 Not Found: " << request.path << std::endl;
-                response.status_code = 404;
-                response.status_text = "Not Found";
-                response.headers["Content-Type"] = "text/plain";
-                response.body = "404 Not Found";
+        route_request();
+        admit_request();
+        if (shed_) {
+            // 请求已被拒绝（超出速率/并发上限，或头部检查未通过）：丢弃已读取的数据，
+            // 由process_request回复错误后关闭连接
+            read_buffer_.clear();
+            request_buffer_.clear();
+            update_activity();
+            std::cout << "请求被拒绝（" << shed_status_ << "），不再读取body" << std::endl;
+        } else {
+            // 取出第一个完整请求，流水线中的后续请求留在读取缓冲区
+            size_t request_length = buffered_request_length();
+            if (request_length == 0) {
+                request_length = read_buffer_.size();
             }
-        } else if (request.method == "DELETE") {
-            if (request.path.substr(0, 8) == "/delete/") {
-                std::cout << "处理文件删除请求: " << request.path << std::endl;
-                response = http_handler.handle_delete_file(request);
-            } else {
-                std::cout << "404 Not Found: " << request.path << std::endl;
-                response.status_code = 404;
-                response.status_text = "Not Found";
-                response.headers["Content-Type"] = "text/plain";
-                response.body = "404 Not Found";
+            request_buffer_.assign(read_buffer_, 0, request_length);
+            read_buffer_.erase(0, request_length);
+            // 请求在request_buffer_中的偏移不变，解析结果直接接手；parser_从下一个请求开始
+            request_parser_ = parser_;
+            request_parser_.parse(request_buffer_);
+            parser_.reset();
+            request_route_ = std::move(route_);
+            routed_ = false;
+            update_activity();
+            if (!read_buffer_.empty()) {
+                request_start_ = last_activity_;
             }
-        } else {
-            std::cout << "405 Method Not Allowed: " << request.method << std::endl;
-            response.status_code = 405;
-            response.status_text = "Method Not Allowed";
-            response.headers["Content-Type"] = "text/plain";
-            response.body = "405 Method Not Allowed";
+            
+            std::cout << "收到 " << request_length << " 字节请求数据" << std::endl;
         }
         
-        std::cout << "响应状态: " << response.status_code << " " << response.status_text << std::endl;
-        
-        // 构建HTTP响应
-        std::string response_data = http_handler.build_response(response);
-        
-        std::cout << "发送响应，长度: " << response_data.length() << " 字节" << std::endl;
+        // 交给服务器分发（例如投递到工作线程池），避免阻塞I/O线程
+        set_state(ConnectionState::PROCESSING);
+        if (dispatcher_) {
+            dispatcher_(shared_from_this());
+            return;
+        }
         
         // 发送响应
-        async_write(response_data);
-        
-        // 清空读取缓冲区，准备下一次读取
-        read_buffer_.clear();
+        async_write(process_request());
         
-        // 不要在这里立即调用async_read，等待写入完成后再调用
-        // set_state(ConnectionState::READING);
-        // async_read();
+        // 不要在这里立即调用async_read，等待写入完成后再读取下一个请求
     } else {
         std::cout << "读取完成，字节数为0，关闭连接" << std::endl;
         set_state(ConnectionState::CLOSING);
     }
 }
 
+ResponseBuffer Connection::process_request() {
+    if (shed_) {
+        return reject_request(shed_status_);
+    }
+    
+    // 流式接收的body已由body_sink_处理完，request_buffer_中只有头部
+    std::unique_ptr<BodySink> body_sink = std::move(body_sink_);
+    body_checked_ = false;
+    headers_checked_ = false;
+    HttpHandler::Route& route = request_route_;
+    
+    // request_parser_已在取出请求时解析过request_buffer_，内容固定的小响应直接使用其中的视图，
+    // 不构造HttpRequest；request_buffer_保留容量供下一个请求使用
+    keep_alive_ = request_wants_keep_alive(request_parser_);
+    ResponseBuffer fixed_response;
+    bool fixed = true;
+    if (route.endpoint == Endpoint::NOT_FOUND) {
+        std::cout << "404 Not Found: " << request_parser_.path() << std::endl;
+        fixed_response = simple_response(404, "text/plain; charset=utf-8", "404 Not Found");
+    } else if (route.endpoint == Endpoint::METHOD_NOT_ALLOWED) {
+        std::cout << "405 Method Not Allowed: " << request_parser_.method() << std::endl;
+        fixed_response = simple_response(405, "text/plain; charset=utf-8", "405 Method Not Allowed");
+    } else if (route.endpoint == Endpoint::STATS) {
+        fixed_response = simple_response(200, "application/json; charset=utf-8",
+                                         "{\"status\":\"success\",\"message\":\"性能统计信息\"}");
+    } else {
+        fixed = false;
+    }
+    if (fixed) {
+        request_buffer_.clear();
+        return fixed_response;
+    }
+    
+    // 其余端点需要完整的HttpRequest
+    std::string request_data;
+    request_data.swap(request_buffer_);
+    
+    HttpHandler http_handler;
+    request_parser_.parse(request_data);
+    HttpRequest request = HttpHandler::make_request(request_parser_, request_data);
+    request.name = std::move(route.name);
+    
+    std::cout << "解析的请求: " << request.method << " " << request.path << std::endl;
+    
+    // 处理HTTP请求：调用路由表中注册的处理函数，流式接收的上传由body_sink生成响应
+    HttpResponse response;
+    if (body_sink) {
+        std::cout << "完成流式上传请求: " << request.path << std::endl;
+        response = body_sink->finish();
+    } else {
+        std::cout << "处理请求: " << request.method << " " << request.path << std::endl;
+        response = (http_handler.*route.handler)(request);
+    }
+    
+    std::cout << "响应状态: " << response.status_code << " " << response.status_text << std::endl;
+    
+    if (keep_alive_) {
+        response.headers["Connection"] = "keep-alive";
+        response.headers["Keep-Alive"] = "timeout=" + std::to_string(PerformanceConfig::KEEP_ALIVE_TIMEOUT_MS / 1000);
+    } else {
+        response.headers["Connection"] = "close";
+    }
+    
+    // 构建HTTP响应，body直接移入响应缓冲区
+    ResponseBuffer response_data = http_handler.build_response(std::move(response));
+    
+    std::cout << "发送响应，长度: " << response_data.size() << " 字节" << std::endl;
+    
+    return response_data;
+}
+
+TaskType Connection::classify_request() const {
+    return classify_endpoint(request_route_.endpoint);
+}
+
+ResponseBuffer Connection::simple_response(int status_code, std::string_view content_type, std::string_view body) {
+    std::cout << "响应状态: " << status_code << " " << ResponseWriter::status_text(status_code) << std::endl;
+    
+    ResponseBuffer response_data;
+    ResponseWriter::write_simple(status_code, content_type, body, keep_alive_, std::string_view(), response_data.head);
+    return response_data;
+}
+
+ResponseBuffer Connection::reject_request(int status_code) {
+    request_buffer_.clear();
+    keep_alive_ = false;
+    
+    // 过载拒绝稍后重试即可，请求本身的错误（413/404等）重试也不会成功
+    std::string_view extra_headers;
+    if (status_code == 429 || status_code == 503) {
+        PerformanceConfig::global_metrics.rejected_connections++;
+        extra_headers = "Retry-After: 1\r\n";
+    }
+    
+    std::string_view status_text = ResponseWriter::status_text(status_code);
+    char body[64];
+    int body_length = std::snprintf(body, sizeof(body), "%d %.*s", status_code,
+                                    static_cast<int>(status_text.size()), status_text.data());
+    
+    std::cout << "拒绝请求: " << body << std::endl;
+    
+    ResponseBuffer response_data;
+    ResponseWriter::write_simple(status_code, "text/plain; charset=utf-8",
+                                 std::string_view(body, static_cast<size_t>(body_length)),
+                                 false, extra_headers, response_data.head);
+    return response_data;
+}
+
 void Connection::handle_write_completion(size_t bytes_written) {
+    if (pending_write_bytes() == 0) {
+        set_cork(false);
+    }
     if (bytes_written > 0) {
-        write_buffer_.erase(0, bytes_written);
         update_activity();
         
         std::cout << "写入完成回调: 已写入 " << bytes_written << " 字节" << std::endl;
         
-        if (write_buffer_.empty()) {
-            std::cout << "响应发送完成，准备关闭连接..." << std::endl;
+        if (pending_write_bytes() == 0) {
+            requests_served_++;
+            release_admission();
             
-            // 等待数据完全发送到网络
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (keep_alive_) {
+                // 持久连接：回到读取状态，已缓存的流水线请求立即处理
+                std::cout << "响应发送完成，保持连接" << std::endl;
+                set_state(ConnectionState::READING);
+                if (request_ready()) {
+                    handle_read_completion(read_buffer_.size());
+                }
+                return;
+            }
+            
+            std::cout << "响应发送完成，准备关闭连接..." << std::endl;
             
             // 关闭连接
             std::cout << "关闭连接..." << std::endl;
             set_state(ConnectionState::CLOSING);
             
-            // 发送shutdown信号
-            shutdown(socket_, SD_SEND);
+            // 发送shutdown信号（io_uring链接close时socket已交给内核，无需shutdown）
+            if (socket_ != INVALID_SOCKET) {
+                shutdown(socket_, SD_SEND);
+            }
             
+#ifdef _WIN32
             // 关闭socket
             socket_close(socket_);
+            socket_ = INVALID_SOCKET;
             set_state(ConnectionState::CLOSED);
+#else
+            // Linux下由epoll线程在本轮事件处理后注销并关闭socket
+#endif
         }
     } else {
         set_state(ConnectionState::CLOSING);
@@ -394,11 +1265,22 @@ void Connection::handle_write_completion(size_t bytes_written) {
 Server::Server(const std::string& address, int port, size_t max_connections, size_t thread_pool_size)
     : address_(address), port_(port), server_socket_(INVALID_SOCKET), running_(false), 
       active_connections_(0), total_requests_(0),
-      max_connections_(max_connections), thread_pool_size_(thread_pool_size) {
+      max_connections_(max_connections), thread_pool_size_(thread_pool_size),
+#ifdef _WIN32
+      timer_wheel_(PerformanceConfig::TIMER_WHEEL_SLOTS,
+                   std::chrono::milliseconds(PerformanceConfig::TIMER_WHEEL_TICK_MS)),
+      connection_pool_(std::make_shared<ConnectionPool>(PerformanceConfig::CONNECTION_POOL_MAX_IDLE)),
+#endif
+      reactor_mode_(ReactorMode::SHARED_ACCEPTOR), reactor_count_(1), io_backend_(IoBackend::EPOLL) {
     
     // 注意：WSAStartup在main函数中已经调用，这里不需要重复调用
     
-    task_queue_ = std::make_unique<TaskQueue>();
+    cpu_lane_ = std::make_unique<WorkStealingPool>("CPU通道", thread_pool_size_,
+                                                   PerformanceConfig::DEFAULT_TASK_QUEUE_SIZE);
+    disk_lane_ = std::make_unique<WorkStealingPool>("磁盘通道", PerformanceConfig::DISK_LANE_THREAD_COUNT,
+                                                    PerformanceConfig::DISK_LANE_QUEUE_SIZE);
+    admission_ = std::make_unique<AdmissionController>(PerformanceConfig::MAX_CONCURRENT_UPLOADS,
+                                                       PerformanceConfig::MAX_CONCURRENT_DOWNLOADS);
 }
 
 Server::~Server() {
@@ -406,27 +1288,51 @@ Server::~Server() {
     // 注意：WSACleanup在main函数中已经调用，这里不需要重复调用
 }
 
-bool Server::start() {
+void Server::set_reactor_mode(ReactorMode mode, size_t loop_count) {
+    reactor_mode_ = mode;
+    if (mode == ReactorMode::REUSEPORT_PER_CORE) {
+        reactor_count_ = loop_count > 0 ? loop_count : (std::max)(1u, std::thread::hardware_concurrency());
+    } else {
+        reactor_count_ = 1;
+    }
+}
+
+socket_t Server::create_listen_socket(bool reuse_port) {
     // 创建socket
 #ifdef _WIN32
-    server_socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    socket_t listen_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
 #else
-    server_socket_ = socket(AF_INET, SOCK_STREAM, 0);
+    socket_t listen_socket = socket(AF_INET, SOCK_STREAM, 0);
 #endif
 
-    if (server_socket_ == INVALID_SOCKET) {
+    if (listen_socket == INVALID_SOCKET) {
         std::cerr << "创建socket失败" << std::endl;
-        return false;
+        return INVALID_SOCKET;
     }
     
     // 设置socket选项
     int opt = 1;
-    if (setsockopt(server_socket_, SOL_SOCKET, SO_REUSEADDR, (char*)&opt, sizeof(opt)) < 0) {
+    if (setsockopt(listen_socket, SOL_SOCKET, SO_REUSEADDR, (char*)&opt, sizeof(opt)) < 0) {
         std::cerr << "设置socket选项失败" << std::endl;
-        socket_close(server_socket_);
-        return false;
+        socket_close(listen_socket);
+        return INVALID_SOCKET;
     }
     
+#ifdef SO_REUSEPORT
+    // 多个监听socket绑定同一端口，由内核按连接哈希分发到各事件循环
+    if (reuse_port && setsockopt(listen_socket, SOL_SOCKET, SO_REUSEPORT, (char*)&opt, sizeof(opt)) < 0) {
+        std::cerr << "设置SO_REUSEPORT失败" << std::endl;
+        socket_close(listen_socket);
+        return INVALID_SOCKET;
+    }
+#else
+    if (reuse_port) {
+        std::cerr << "当前平台不支持SO_REUSEPORT" << std::endl;
+        socket_close(listen_socket);
+        return INVALID_SOCKET;
+    }
+#endif
+    
     // 绑定地址
     struct sockaddr_in server_addr;
     memset(&server_addr, 0, sizeof(server_addr));
@@ -436,39 +1342,48 @@ bool Server::start() {
     if (address_ == "0.0.0.0" || address_ == "") {
         // 监听所有地址
         server_addr.sin_addr.s_addr = INADDR_ANY;
-        std::cout << "监听所有网络接口" << std::endl;
     } else {
         // 解析指定的IP地址
         if (inet_pton(AF_INET, address_.c_str(), &server_addr.sin_addr) != 1) {
             std::cerr << "无效的IP地址: " << address_ << std::endl;
-            socket_close(server_socket_);
-            return false;
+            socket_close(listen_socket);
+            return INVALID_SOCKET;
         }
-        std::cout << "监听指定地址: " << address_ << std::endl;
     }
     
     server_addr.sin_port = htons(port_);
     
-    if (bind(server_socket_, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+    if (bind(listen_socket, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
         std::cerr << "绑定地址 " << address_ << ":" << port_ << " 失败" << std::endl;
-        socket_close(server_socket_);
-        return false;
+        socket_close(listen_socket);
+        return INVALID_SOCKET;
     }
     
     // 监听连接
-    if (listen(server_socket_, static_cast<int>(max_connections_)) < 0) {
+    if (listen(listen_socket, static_cast<int>(max_connections_)) < 0) {
         std::cerr << "监听失败" << std::endl;
-        socket_close(server_socket_);
-        return false;
+        socket_close(listen_socket);
+        return INVALID_SOCKET;
+    }
+    
+    return listen_socket;
+}
+
+bool Server::start() {
+    if (address_ == "0.0.0.0" || address_ == "") {
+        std::cout << "监听所有网络接口" << std::endl;
+    } else {
+        std::cout << "监听指定地址: " << address_ << std::endl;
     }
     
-    // 设置平台特定的I/O
 #ifdef _WIN32
-    if (!setup_iocp()) {
+    server_socket_ = create_listen_socket(false);
+    if (server_socket_ == INVALID_SOCKET) {
         return false;
     }
-#else
-    if (!setup_epoll()) {
+    
+    // 设置平台特定的I/O
+    if (!setup_iocp()) {
         return false;
     }
 #endif
@@ -476,20 +1391,29 @@ bool Server::start() {
     std::cout << "高性能异步服务器启动成功！" << std::endl;
     std::cout << "监听地址: " << address_ << ":" << port_ << std::endl;
     std::cout << "最大连接数: " << max_connections_ << std::endl;
-    std::cout << "工作线程数: " << thread_pool_size_ << std::endl;
     
     running_ = true;
     
+#ifdef _WIN32
+    std::cout << "工作线程数: " << thread_pool_size_ << std::endl;
+    
     // 启动工作线程池
-    for (size_t i = 0; i < thread_pool_size_; ++i) {
-        worker_threads_.emplace_back(&Server::worker_thread_loop, this);
-    }
+    cpu_lane_->start([this](AsyncTask& task) {
+        handle_async_task(task);
+    });
     
     // 启动IOCP完成处理线程
     iocp_thread_ = std::thread(&Server::handle_iocp_completion, this);
     
     // 启动接受连接线程
     accept_thread_ = std::thread(&Server::accept_connections, this);
+#else
+    if (!start_event_loops()) {
+        running_ = false;
+        loops_.clear();
+        return false;
+    }
+#endif
     
     return true;
 }
@@ -499,19 +1423,24 @@ void Server::stop() {
     
     running_ = false;
     
+#ifndef _WIN32
+    // 先停止事件循环线程，再关闭它们正在使用的socket
+    for (auto& loop : loops_) {
+        loop->stop();
+    }
+#endif
+    
     // 关闭socket
     if (server_socket_ != INVALID_SOCKET) {
         socket_close(server_socket_);
         server_socket_ = INVALID_SOCKET;
     }
     
-    // 等待工作线程结束
-    for (auto& thread : worker_threads_) {
-        if (thread.joinable()) {
-            thread.join();
-        }
-    }
+    // 唤醒并结束工作线程
+    cpu_lane_->stop();
+    disk_lane_->stop();
     
+#ifdef _WIN32
     // 等待IOCP线程结束
     if (iocp_thread_.joinable()) {
         iocp_thread_.join();
@@ -521,10 +1450,15 @@ void Server::stop() {
     if (accept_thread_.joinable()) {
         accept_thread_.join();
     }
+#else
+    // 工作线程可能仍在向事件循环投递回调，全部结束后再销毁事件循环
+    loops_.clear();
+#endif
     
     std::cout << "服务器已停止" << std::endl;
 }
 
+#ifdef _WIN32
 void Server::accept_connections() {
     std::cout << "开始接受连接线程..." << std::endl;
     
@@ -548,7 +1482,7 @@ void Server::accept_connections() {
         // 检查连接数限制
         if (active_connections_ >= max_connections_) {
             std::cout << "达到最大连接数限制，拒绝新连接" << std::endl;
-            socket_close(client_socket);
+            admission_->reject_connection(client_socket);
             continue;
         }
         
@@ -566,7 +1500,8 @@ void Server::accept_connections() {
         }
         
         // 创建新连接
-        auto connection = std::make_shared<Connection>(client_socket, client_ip);
+        auto connection = connection_pool_->acquire(client_socket, client_ip);
+        connection->set_admission_controller(admission_.get());
         add_connection(connection);
         
         std::cout << "接受来自 " << client_ip << ":" << ntohs(client_addr.sin_port) 
@@ -577,20 +1512,11 @@ void Server::accept_connections() {
         connection->async_read();
     }
 }
-
-void Server::worker_thread_loop() {
-    while (running_) {
-        AsyncTask task;
-        if (task_queue_->pop(task)) {
-            handle_async_task(task);
-        }
-        
-        // 清理过期连接
-        cleanup_expired_connections();
-    }
-}
+#endif
 
 void Server::handle_async_task(AsyncTask& task) {
+    // 只是跳过已关闭连接的优化：检查之后连接仍可能被事件循环关闭，
+    // 此时生成的响应由事件循环在写回前丢弃（complete_request再次检查）
     if (!task.connection || !task.connection->is_active()) {
         return;
     }
@@ -599,38 +1525,51 @@ void Server::handle_async_task(AsyncTask& task) {
         if (task.callback) {
             task.callback();
         }
-        total_requests_++;
     } catch (const std::exception& e) {
         std::cerr << "处理异步任务时发生异常: " << e.what() << std::endl;
     }
 }
 
 void Server::cleanup_expired_connections() {
+#ifdef _WIN32
     std::lock_guard<std::mutex> lock(connections_mutex_);
     
-    auto it = connections_.begin();
-    while (it != connections_.end()) {
-        if (!(*it)->is_active() || (*it)->is_expired()) {
-            std::cout << "清理过期连接: " << (*it)->get_client_ip() << std::endl;
-            it = connections_.erase(it);
+    // 只检查时间轮中到期槽位的连接，不再扫描全部连接
+    timer_wheel_.advance(std::chrono::steady_clock::now(), [this](const std::shared_ptr<Connection>& conn) {
+        if (conn->is_active()) {
+            std::cout << "清理过期连接: " << conn->get_client_ip() << std::endl;
+            conn->close();
+        }
+        
+        if (connections_.erase(conn->get_handle())) {
             active_connections_--;
-        } else {
-            ++it;
         }
-    }
+    });
+#endif
 }
 
 void Server::add_connection(std::shared_ptr<Connection> conn) {
     std::lock_guard<std::mutex> lock(connections_mutex_);
-    connections_.push_back(conn);
+    
+    ConnectionHandle handle = connections_.insert(conn->get_socket(), conn);
+    if (handle == INVALID_CONNECTION_HANDLE) {
+        // 旧连接自行关闭后尚未被时间轮回收，其socket句柄已被系统复用
+        std::shared_ptr<Connection> stale = connections_.find(conn->get_socket());
+        if (stale && connections_.erase(stale->get_handle())) {
+            active_connections_--;
+        }
+        handle = connections_.insert(conn->get_socket(), conn);
+    }
+    conn->set_handle(handle);
+#ifdef _WIN32
+    timer_wheel_.schedule(conn);
+#endif
     active_connections_++;
 }
 
 void Server::remove_connection(std::shared_ptr<Connection> conn) {
     std::lock_guard<std::mutex> lock(connections_mutex_);
-    auto it = std::find(connections_.begin(), connections_.end(), conn);
-    if (it != connections_.end()) {
-        connections_.erase(it);
+    if (connections_.erase(conn->get_handle())) {
         active_connections_--;
     }
 }
@@ -677,59 +1616,154 @@ void Server::handle_iocp_completion() {
                 std::cerr << "IOCP等待失败，错误码: " << error << std::endl;
             }
         }
+        
+        // 推进连接超时时间轮
+        cleanup_expired_connections();
     }
     
     std::cout << "IOCP完成处理线程退出" << std::endl;
 }
 #else
-bool Server::setup_epoll() {
-    epoll_handle_ = epoll_create1(0);
-    if (epoll_handle_ == -1) {
-        std::cerr << "创建epoll失败" << std::endl;
-        return false;
+bool Server::start_event_loops() {
+    bool reuse_port = (reactor_mode_ == ReactorMode::REUSEPORT_PER_CORE);
+    size_t cpu_count = (std::max)(1u, std::thread::hardware_concurrency());
+    size_t max_connections_per_loop = (std::max)(size_t(1), max_connections_ / reactor_count_);
+    
+    bool use_uring = false;
+    if (io_backend_ == IoBackend::IO_URING) {
+#ifdef HAVE_IO_URING
+        use_uring = UringEventLoop::is_supported();
+#endif
+        if (!use_uring) {
+            std::cout << "当前系统不支持io_uring，回退到epoll" << std::endl;
+        }
     }
     
-    // 将服务器socket添加到epoll
-    struct epoll_event event;
-    event.events = EPOLLIN;
-    event.data.ptr = nullptr;
+    for (size_t i = 0; i < reactor_count_; ++i) {
+        socket_t listen_socket = create_listen_socket(reuse_port);
+        if (listen_socket == INVALID_SOCKET) {
+            return false;
+        }
+        
+        std::unique_ptr<EventLoop> loop;
+#ifdef HAVE_IO_URING
+        if (use_uring) {
+            loop = std::make_unique<UringEventLoop>(i, listen_socket, max_connections_per_loop);
+        }
+#endif
+        if (!loop) {
+            loop = std::make_unique<EpollEventLoop>(i, listen_socket, max_connections_per_loop);
+        }
+        loop->set_request_handler([this](EventLoop& owner, std::shared_ptr<Connection> conn) {
+            return dispatch_request(owner, std::move(conn));
+        });
+        loop->set_admission_controller(admission_.get());
+        loop->set_disk_handler([this](std::shared_ptr<Connection> conn, std::function<void()> work) {
+            return disk_lane_->submit(AsyncTask(TaskType::FILE_UPLOAD, std::move(conn), std::move(work)));
+        });
+        
+        // 每核一个循环时绑定CPU，连接从接受到关闭都在同一核心上处理
+        int cpu = reuse_port ? static_cast<int>(i % cpu_count) : -1;
+        if (!loop->start(cpu)) {
+            return false;
+        }
+        loops_.push_back(std::move(loop));
+    }
     
-    if (epoll_ctl(epoll_handle_, EPOLL_CTL_ADD, server_socket_, &event) == -1) {
-        std::cerr << "添加服务器socket到epoll失败" << std::endl;
-        return false;
+    std::cout << "I/O后端: " << (use_uring ? "io_uring" : "epoll") << std::endl;
+    auto handler = [this](AsyncTask& task) {
+        handle_async_task(task);
+    };
+    
+    if (reuse_port) {
+        std::cout << "反应器模式: SO_REUSEPORT，每核一个事件循环，共 " << reactor_count_ << " 个" << std::endl;
+    } else {
+        std::cout << "反应器模式: 共享接受线程 + 工作线程池" << std::endl;
+        std::cout << "CPU通道线程数: " << thread_pool_size_ << std::endl;
+        cpu_lane_->start(handler);
     }
     
-    epoll_events_.resize(1000);  // 预分配事件数组
+    // 两种模式下文件上传、下载、删除都交给磁盘通道，避免慢速磁盘操作阻塞其他请求
+    std::cout << "磁盘通道线程数: " << disk_lane_->thread_count() << std::endl;
+    disk_lane_->start(handler);
+    
     return true;
 }
 
-void Server::handle_epoll_events() {
-    while (running_) {
-        int num_events = epoll_wait(epoll_handle_, epoll_events_.data(), 
-                                   static_cast<int>(epoll_events_.size()), 100);
-        
-        if (num_events > 0) {
-            for (int i = 0; i < num_events; ++i) {
-                // 处理epoll事件
-                if (epoll_events_[i].events & EPOLLIN) {
-                    // 处理读取事件
-                }
-                if (epoll_events_[i].events & EPOLLOUT) {
-                    // 处理写入事件
-                }
-            }
-        }
+bool Server::dispatch_request(EventLoop& loop, std::shared_ptr<Connection> conn) {
+    // 被准入控制拒绝的请求只需回复503，在事件循环中内联完成
+    if (conn->is_shed()) {
+        return false;
+    }
+    
+    TaskType type = conn->classify_request();
+    bool disk_task = type == TaskType::FILE_UPLOAD || type == TaskType::FILE_DOWNLOAD ||
+                     type == TaskType::FILE_DELETE;
+    
+    // 每核模式下轻量请求直接在所属事件循环处理
+    if (!disk_task && reactor_mode_ == ReactorMode::REUSEPORT_PER_CORE) {
+        return false;
+    }
+    
+    EventLoop* owner = &loop;
+    WorkStealingPool& lane = disk_task ? *disk_lane_ : *cpu_lane_;
+    bool queued = lane.submit(AsyncTask(type, conn, [owner, conn]() {
+        // socket只在所属事件循环线程中读写
+        owner->complete_request(conn, conn->process_request());
+    }));
+    
+    // 背压：通道队列已满时不再排队，直接返回503让客户端稍后重试
+    if (!queued) {
+        loop.complete_request(conn, conn->reject_request(503));
     }
+    return true;
 }
 #endif
 
 // 性能统计方法
 size_t Server::get_active_connections() const {
-    return active_connections_;
+    size_t total = active_connections_;
+#ifndef _WIN32
+    for (const auto& loop : loops_) {
+        total += loop->get_active_connections();
+    }
+#endif
+    return total;
 }
 
 size_t Server::get_total_requests() const {
-    return total_requests_;
+    size_t total = total_requests_;
+#ifndef _WIN32
+    for (const auto& loop : loops_) {
+        total += loop->get_total_requests();
+    }
+#endif
+    return total;
+}
+
+void Server::print_lane_stats() const {
+    for (const WorkStealingPool* lane : {cpu_lane_.get(), disk_lane_.get()}) {
+        WorkStealingPool::Metrics metrics = lane->get_metrics();
+        std::cout << "  " << metrics.name << ": 线程 " << metrics.threads
+                  << ", 排队 " << metrics.pending << "/" << metrics.queue_capacity
+                  << ", 执行中 " << metrics.active
+                  << ", 完成 " << metrics.completed
+                  << ", 拒绝 " << metrics.rejected
+                  << ", 窃取 " << metrics.stolen
+                  << ", 平均排队 " << metrics.avg_wait_ms << " ms" << std::endl;
+    }
+    
+    AdmissionController::Metrics admission = admission_->get_metrics();
+    std::cout << "  准入控制: 上传 " << admission.uploads_in_flight << "/" << admission.max_uploads
+              << " (拒绝 " << admission.rejected_uploads << ")"
+              << ", 下载 " << admission.downloads_in_flight << "/" << admission.max_downloads
+              << " (拒绝 " << admission.rejected_downloads << ")"
+              << ", 拒绝连接 " << admission.rejected_connections << std::endl;
+    
+    RateLimiter::Metrics limiter = admission_->rate_limiter().get_metrics();
+    std::cout << "  限流: 客户端 " << limiter.clients
+              << ", 超速请求 " << limiter.limited_requests
+              << ", 限速发送 " << limiter.throttled_sends << std::endl;
 }
 
 double Server::get_requests_per_second() const {
@@ -741,7 +1775,7 @@ double Server::get_requests_per_second() const {
     auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - last_time).count();
     
     if (elapsed > 0) {
-        size_t current_requests = total_requests_;
+        size_t current_requests = get_total_requests();
         size_t requests_diff = current_requests - last_requests;
         double rps = static_cast<double>(requests_diff) / elapsed;
         
@@ -29,56 +29,36 @@ void handle_client(SOCKET client_socket, const std::string& client_ip) {
         
         std::cout << "解析的请求: " << request.method << " " << request.path << std::endl;
         
-        // 处理HTTP请求
+        // 处理HTTP请求：调用路由表中注册的处理函数
         HttpResponse response;
-        if (request.method == "GET") {
-            if (request.path == "/files") {
-                std::cout << "处理文件列表请求" << std::endl;
-                response = http_handler.handle_list_files(request);
-            } else if (request.path.substr(0, 10) == "/download/") {
-                std::cout << "处理文件下载请求: " << request.path << std::endl;
-                response = http_handler.handle_download(request);
-            } else if (request.path == "/stats") {
-                std::cout << "处理性能统计请求" << std::endl;
-                response.status_code = 200;
-                response.status_text = "OK";
-                response.headers["Content-Type"] = "application/json";
-                response.body = "{\"status\":\"success\",\"message\":\"性能统计信息\"}";
-            } else {
-                std::cout << "404 Not Found: " << request.path << std::endl;
-                response.status_code = 404;
-                response.status_text = "Not Found";
-                response.headers["Content-Type"] = "text/plain";
-                response.body = "404 Not Found";
-            }
-        } else if (request.method == "POST") {
-            if (request.path == "/upload") {
-                std::cout << "处理文件上传请求" << std::endl;
-                response = http_handler.handle_upload(request);
-            } else {
-                std::cout << "404 Not Found: " << request.path << std::endl;
-                response.status_code = 404;
-                response.status_text = "Not Found";
-                response.headers["Content-Type"] = "text/plain";
-                response.body = "404 Not Found";
-            }
-        } else if (request.method == "DELETE") {
-            if (request.path.substr(0, 8) == "/delete/") {
-                std::cout << "处理文件删除请求: " << request.path << std::endl;
-                response = http_handler.handle_delete_file(request);
-            } else {
-                std::cout << "404 Not Found: " << request.path << std::endl;
-                response.status_code = 404;
-                response.status_text = "Not Found";
-                response.headers["Content-Type"] = "text/plain";
-                response.body = "404 Not Found";
-            }
-        } else {
+        HttpHandler::Route route = HttpHandler::route(request.method, request.path);
+        request.name = route.name;
+        switch (route.endpoint) {
+        case Endpoint::STATS:
+            std::cout << "处理性能统计请求" << std::endl;
+            response.status_code = 200;
+            response.status_text = "OK";
+            response.headers["Content-Type"] = "application/json";
+            response.body = "{\"status\":\"success\",\"message\":\"性能统计信息\"}";
+            break;
+        case Endpoint::NOT_FOUND:
+            std::cout << "404 Not Found: " << request.path << std::endl;
+            response.status_code = 404;
+            response.status_text = "Not Found";
+            response.headers["Content-Type"] = "text/plain";
+            response.body = "404 Not Found";
+            break;
+        case Endpoint::METHOD_NOT_ALLOWED:
             std::cout << "405 Method Not Allowed: " << request.method << std::endl;
             response.status_code = 405;
             response.status_text = "Method Not Allowed";
             response.headers["Content-Type"] = "text/plain";
             response.body = "405 Method Not Allowed";
+            break;
+        default:
+            std::cout << "处理请求: " << request.method << " " << request.path << std::endl;
+            response = (http_handler.*route.handler)(request);
+            break;
         }
         
         std::cout << "响应状态: " << response.status_code << " " << response.status_text << std::endl;
@@ -0,0 +1,129 @@
+#include "../include/simd_scan.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+    #define SIMD_SCAN_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SIMD_SCAN_SSE2 1
+#endif
+
+#if defined(SIMD_SCAN_AVX2)
+    #include <immintrin.h>
+#elif defined(SIMD_SCAN_SSE2)
+    #include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(SIMD_SCAN_AVX2) || defined(SIMD_SCAN_SSE2))
+    #include <intrin.h>
+#endif
+
+namespace {
+#if defined(SIMD_SCAN_AVX2) || defined(SIMD_SCAN_SSE2)
+    inline unsigned lowest_bit(uint32_t mask) {
+    #ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned>(index);
+    #else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+    #endif
+    }
+
+    // mask中每一位对应一个首末字节都匹配的候选位置，逐个比较中间部分
+    inline bool match_candidates(uint32_t mask, const char* block, const char* needle, size_t needle_length,
+                                 size_t& offset) {
+        while (mask != 0) {
+            unsigned bit = lowest_bit(mask);
+            if (std::memcmp(block + bit + 1, needle + 1, needle_length - 2) == 0) {
+                offset = bit;
+                return true;
+            }
+            mask &= mask - 1;
+        }
+        return false;
+    }
+#endif
+}
+
+namespace SimdScan {
+
+size_t find(const char* data, size_t length, const char* needle, size_t needle_length) {
+    if (needle_length == 0) {
+        return 0;
+    }
+    if (length < needle_length) {
+        return length;
+    }
+    if (needle_length == 1) {
+        const void* found = std::memchr(data, needle[0], length);
+        return found ? static_cast<size_t>(static_cast<const char*>(found) - data) : length;
+    }
+
+    // 可能的起始位置为[0, starts)；一块的末字节比较读取到data[i + block + needle_length - 2]，不越界
+    const size_t starts = length - needle_length + 1;
+    const size_t last_offset = needle_length - 1;
+    size_t i = 0;
+    size_t offset = 0;
+
+#if defined(SIMD_SCAN_AVX2)
+    {
+        const __m256i first = _mm256_set1_epi8(needle[0]);
+        const __m256i last = _mm256_set1_epi8(needle[last_offset]);
+        for (; i + 32 <= starts; i += 32) {
+            __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + last_offset));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last))));
+            if (match_candidates(mask, data + i, needle, needle_length, offset)) {
+                return i + offset;
+            }
+        }
+    }
+#endif
+
+#if defined(SIMD_SCAN_SSE2)
+    {
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i last = _mm_set1_epi8(needle[last_offset]);
+        for (; i + 16 <= starts; i += 16) {
+            __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + last_offset));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last))));
+            if (match_candidates(mask, data + i, needle, needle_length, offset)) {
+                return i + offset;
+            }
+        }
+    }
+#endif
+
+    // 剩余不足一块的部分（或没有向量指令时的全部数据）：memchr定位首字节后再比较
+    while (i < starts) {
+        const void* found = std::memchr(data + i, needle[0], starts - i);
+        if (!found) {
+            break;
+        }
+        i = static_cast<size_t>(static_cast<const char*>(found) - data);
+        if (data[i + last_offset] == needle[last_offset] &&
+            std::memcmp(data + i + 1, needle + 1, needle_length - 2) == 0) {
+            return i;
+        }
+        ++i;
+    }
+    return length;
+}
+
+const char* instruction_set() {
+#if defined(SIMD_SCAN_AVX2)
+    return "AVX2";
+#elif defined(SIMD_SCAN_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+}
@@ -0,0 +1,77 @@
+#include "../include/timer_wheel.h"
+#include "../include/server.h"
+#include <algorithm>
+
+TimerWheel::TimerWheel(size_t slot_count, std::chrono::milliseconds tick)
+    : slots_((std::max)(slot_count, size_t(1))), tick_(tick), start_(Clock::now()),
+      current_tick_(0), size_(0) {}
+
+uint64_t TimerWheel::tick_of(Clock::time_point when) const {
+    if (when <= start_) return 0;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(when - start_);
+    // 向上取整，保证连接不会早于截止时间被判定超时
+    return static_cast<uint64_t>((elapsed.count() + tick_.count() - 1) / tick_.count());
+}
+
+void TimerWheel::schedule(const std::shared_ptr<Connection>& conn) {
+    insert(conn, conn->deadline());
+    size_++;
+}
+
+void TimerWheel::insert(const std::shared_ptr<Connection>& conn, Clock::time_point deadline) {
+    // 超出一圈的截止时间（以及不超时的连接）先挂在一圈之后，到时再重新检查
+    uint64_t horizon = current_tick_ + slots_.size();
+    uint64_t expire_tick = deadline == Clock::time_point::max() ? horizon : tick_of(deadline);
+    expire_tick = (std::max)(expire_tick, current_tick_ + 1);
+    expire_tick = (std::min)(expire_tick, horizon);
+
+    slots_[expire_tick % slots_.size()].push_back(Entry{conn, expire_tick});
+}
+
+void TimerWheel::advance(Clock::time_point now, const ExpireHandler& on_expired) {
+    uint64_t now_tick = tick_of(now);
+
+    // 长时间未推进时，最多扫描一圈即可覆盖所有槽位
+    if (now_tick > current_tick_ + slots_.size()) {
+        current_tick_ = now_tick - slots_.size();
+    }
+
+    while (current_tick_ < now_tick) {
+        ++current_tick_;
+        std::vector<Entry>& slot = slots_[current_tick_ % slots_.size()];
+        if (slot.empty()) continue;
+
+        due_.clear();
+        due_.swap(slot);
+
+        for (Entry& entry : due_) {
+            std::shared_ptr<Connection> conn = entry.conn.lock();
+            if (!conn) {
+                size_--;
+                continue;
+            }
+
+            // 跳圈处理时槽位里可能还有更晚的节点，原样放回
+            if (entry.expire_tick > current_tick_) {
+                slot.push_back(std::move(entry));
+                continue;
+            }
+
+            Clock::time_point deadline = conn->deadline();
+            if (!conn->is_active() || deadline <= now) {
+                size_--;
+                on_expired(conn);
+            } else {
+                insert(conn, deadline);
+            }
+        }
+    }
+}
+
+void TimerWheel::clear() {
+    for (auto& slot : slots_) {
+        slot.clear();
+    }
+    due_.clear();
+    size_ = 0;
+}
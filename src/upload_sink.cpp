@@ -0,0 +1,183 @@
+#include "../include/upload_sink.h"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MultipartUploadSink::MultipartUploadSink(const std::string& boundary)
+    : parser_(boundary, *this), current_failed_(false) {}
+
+bool MultipartUploadSink::write(const char* data, size_t length) {
+    return parser_.feed(data, length);
+}
+
+HttpResponse MultipartUploadSink::finish() {
+    if (!parser_.finished()) {
+        std::cerr << "multipart数据不完整或格式错误" << std::endl;
+    }
+
+    // body在某个部分中间结束：该文件不完整，临时文件随writer_析构删除
+    if (writer_ || current_failed_) {
+        failed_files_.push_back(current_filename_);
+        writer_.reset();
+        current_failed_ = false;
+    }
+
+    return HttpHandler::build_upload_response(saved_files_, failed_files_);
+}
+
+void MultipartUploadSink::on_part_begin(const std::string& headers) {
+    current_filename_ = http_handler_.part_filename(headers);
+    current_failed_ = false;
+    if (current_filename_.empty()) {
+        return;  // 普通表单字段，内容忽略
+    }
+
+    std::cout << "开始接收上传文件: " << current_filename_ << std::endl;
+    if (!file_manager_) {
+        file_manager_ = std::make_unique<FileManager>();
+    }
+    writer_ = file_manager_->create_file(current_filename_);
+    current_failed_ = !writer_;
+}
+
+void MultipartUploadSink::on_part_data(const char* data, size_t length) {
+    if (writer_ && !writer_->write(data, length)) {
+        writer_.reset();
+        current_failed_ = true;
+    }
+}
+
+void MultipartUploadSink::on_part_end() {
+    if (writer_) {
+        if (writer_->commit()) {
+            saved_files_.push_back(current_filename_);
+        } else {
+            failed_files_.push_back(current_filename_);
+        }
+        writer_.reset();
+    } else if (current_failed_) {
+        failed_files_.push_back(current_filename_);
+    }
+    current_failed_ = false;
+}
+
+RawUploadSink::RawUploadSink(const std::string& filename, std::unique_ptr<FileWriter> writer,
+                             uint64_t expected_length, bool replacing)
+    : filename_(filename), writer_(std::move(writer)), expected_length_(expected_length),
+      replacing_(replacing), splice_supported_(true) {
+    pipe_[0] = -1;
+    pipe_[1] = -1;
+}
+
+RawUploadSink::~RawUploadSink() {
+    close_pipe();
+}
+
+void RawUploadSink::close_pipe() {
+#ifndef _WIN32
+    for (int& fd : pipe_) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+#endif
+}
+
+bool RawUploadSink::write(const char* data, size_t length) {
+    if (!writer_) return false;
+    if (!writer_->write(data, length)) {
+        writer_.reset();
+        return false;
+    }
+    return true;
+}
+
+long long RawUploadSink::receive_from(int socket, uint64_t max_length) {
+#ifdef _WIN32
+    (void)socket;
+    (void)max_length;
+    errno = ENOSYS;
+    return -1;
+#else
+    if (!writer_ || !splice_supported_) {
+        errno = ENOSYS;
+        return -1;
+    }
+    
+    if (pipe_[0] < 0) {
+        if (pipe2(pipe_, O_CLOEXEC | O_NONBLOCK) != 0) {
+            splice_supported_ = false;
+            errno = ENOSYS;
+            return -1;
+        }
+        // 默认64KB的管道每次只能搬运16页，扩大后减少系统调用次数；失败时保持默认容量
+        fcntl(pipe_[1], F_SETPIPE_SZ, static_cast<int>(PIPE_SIZE));
+    }
+    
+    size_t chunk = static_cast<size_t>((std::min)(max_length, static_cast<uint64_t>(PIPE_SIZE)));
+    ssize_t received = splice(socket, nullptr, pipe_[1], nullptr, chunk, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (received < 0 && errno == EINVAL) {
+        // 该socket不支持splice，之后改用recv + write；管道中可能还有待写入的数据，保留到析构
+        splice_supported_ = false;
+        errno = ENOSYS;
+    }
+    return received;
+#endif
+}
+
+bool RawUploadSink::write_received(uint64_t length) {
+#ifdef _WIN32
+    return length == 0;
+#else
+    // 管道中的数据必须全部取出，不留残余；写入失败后读出丢弃
+    while (length > 0) {
+        size_t chunk = static_cast<size_t>((std::min)(length, static_cast<uint64_t>(PIPE_SIZE)));
+        ssize_t moved;
+        if (writer_) {
+            moved = splice(pipe_[0], nullptr, writer_->fd(), nullptr, chunk, SPLICE_F_MOVE);
+        } else {
+            char discard[16 * 1024];
+            moved = ::read(pipe_[0], discard, (std::min)(chunk, sizeof(discard)));
+        }
+        if (moved < 0 && errno == EINTR) continue;
+        if (moved <= 0) {
+            if (!writer_) return false;
+            // 写入失败：上传按失败处理，剩余body仍需读完后丢弃
+            std::cerr << "splice写入文件失败: " << filename_ << std::endl;
+            writer_.reset();
+            continue;
+        }
+        if (writer_) {
+            writer_->add_written(static_cast<uint64_t>(moved));
+        }
+        length -= static_cast<uint64_t>(moved);
+    }
+    return writer_ != nullptr;
+#endif
+}
+
+HttpResponse RawUploadSink::finish() {
+    HttpResponse response;
+    response.headers["Content-Type"] = "text/plain; charset=utf-8";
+    close_pipe();
+    
+    bool complete = writer_ && writer_->size() == expected_length_;
+    if (complete && writer_->commit()) {
+        response.status_code = replacing_ ? 200 : 201;
+        response.status_text = replacing_ ? "OK" : "Created";
+        response.headers["Location"] = "/download/" + HttpHandler::url_encode(filename_);
+        response.body = "成功上传 1 个文件: " + filename_;
+    } else {
+        response.status_code = 500;
+        response.status_text = "Internal Server Error";
+        response.body = "上传失败 1 个文件: " + filename_;
+    }
+    writer_.reset();
+    return response;
+}
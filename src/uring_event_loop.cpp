@@ -0,0 +1,584 @@
+#include "../include/uring_event_loop.h"
+#include "../include/performance_config.h"
+#include <iostream>
+#include <cstring>
+
+#ifdef HAVE_IO_URING
+
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+
+namespace {
+
+// user_data低3位编码操作类型，其余位是ConnectionSlot地址
+enum UringOp : uint64_t {
+    OP_ACCEPT = 1,
+    OP_RECV = 2,
+    OP_SEND = 3,
+    OP_CLOSE = 4,
+    OP_PROVIDE = 5,
+    OP_WAKEUP = 6,
+    OP_TIMEOUT = 7
+};
+constexpr uint64_t OP_MASK = 7;
+constexpr uint64_t OP_CANCEL = 0;  // 取消请求本身的完成事件，user_data为0
+
+constexpr unsigned short BUFFER_GROUP_ID = 1;
+
+int io_uring_setup(unsigned entries, struct io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+} // namespace
+
+// IoUring 实现
+IoUring::IoUring()
+    : ring_fd_(-1), sq_ring_ptr_(MAP_FAILED), sq_ring_size_(0), sq_head_(nullptr), sq_tail_(nullptr),
+      sq_mask_(0), sq_entries_(0), sqes_(nullptr), sqes_size_(0), sqe_tail_(0),
+      cq_ring_ptr_(MAP_FAILED), cq_ring_size_(0), cq_head_(nullptr), cq_tail_(nullptr), cq_mask_(0),
+      cqes_(nullptr) {}
+
+IoUring::~IoUring() {
+    close();
+}
+
+bool IoUring::init(unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CLAMP;
+
+    ring_fd_ = io_uring_setup(entries, &params);
+    if (ring_fd_ < 0) {
+        std::cerr << "io_uring_setup失败，错误码: " << errno << std::endl;
+        ring_fd_ = -1;
+        return false;
+    }
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        sq_ring_size_ = cq_ring_size_ = (std::max)(sq_ring_size_, cq_ring_size_);
+    }
+
+    sq_ring_ptr_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ptr_ == MAP_FAILED) {
+        std::cerr << "映射io_uring提交队列失败" << std::endl;
+        close();
+        return false;
+    }
+
+    if (single_mmap) {
+        cq_ring_ptr_ = sq_ring_ptr_;
+    } else {
+        cq_ring_ptr_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ring_ptr_ == MAP_FAILED) {
+            std::cerr << "映射io_uring完成队列失败" << std::endl;
+            close();
+            return false;
+        }
+    }
+
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes_ptr = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring_fd_, IORING_OFF_SQES);
+    if (sqes_ptr == MAP_FAILED) {
+        std::cerr << "映射io_uring SQE数组失败" << std::endl;
+        close();
+        return false;
+    }
+    sqes_ = static_cast<struct io_uring_sqe*>(sqes_ptr);
+
+    char* sq = static_cast<char*>(sq_ring_ptr_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    sqe_tail_ = *sq_tail_;
+
+    // SQE总是按顺序使用，索引数组固定为恒等映射
+    unsigned* sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < sq_entries_; ++i) {
+        sq_array[i] = i;
+    }
+
+    char* cq = static_cast<char*>(cq_ring_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    return true;
+}
+
+void IoUring::close() {
+    if (sqes_) {
+        munmap(sqes_, sqes_size_);
+        sqes_ = nullptr;
+    }
+    if (cq_ring_ptr_ != MAP_FAILED && cq_ring_ptr_ != sq_ring_ptr_) {
+        munmap(cq_ring_ptr_, cq_ring_size_);
+    }
+    cq_ring_ptr_ = MAP_FAILED;
+    if (sq_ring_ptr_ != MAP_FAILED) {
+        munmap(sq_ring_ptr_, sq_ring_size_);
+        sq_ring_ptr_ = MAP_FAILED;
+    }
+    if (ring_fd_ != -1) {
+        ::close(ring_fd_);
+        ring_fd_ = -1;
+    }
+}
+
+struct io_uring_sqe* IoUring::get_sqe() {
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sqe_tail_ - head >= sq_entries_) {
+        return nullptr;
+    }
+
+    struct io_uring_sqe* sqe = &sqes_[sqe_tail_ & sq_mask_];
+    ++sqe_tail_;
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+int IoUring::submit(unsigned wait_nr) {
+    unsigned to_submit = sqe_tail_ - *sq_tail_;
+    __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+
+    unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int ret;
+    do {
+        ret = io_uring_enter(ring_fd_, to_submit, wait_nr, flags);
+    } while (ret < 0 && errno == EINTR && wait_nr == 0);
+
+    return ret;
+}
+
+// UringEventLoop 实现
+UringEventLoop::UringEventLoop(size_t id, socket_t listen_socket, size_t max_connections)
+    : EventLoop(id, listen_socket, max_connections), wakeup_fd_(-1), wakeup_value_(0) {
+    tick_.tv_sec = PerformanceConfig::TIMER_WHEEL_TICK_MS / 1000;
+    tick_.tv_nsec = (PerformanceConfig::TIMER_WHEEL_TICK_MS % 1000) * 1000000L;
+}
+
+UringEventLoop::~UringEventLoop() {
+    stop();
+
+    // 先关闭环，内核取消仍在进行的操作后再释放它们引用的内存
+    ring_.close();
+    slots_.clear();
+
+    if (wakeup_fd_ != -1) {
+        ::close(wakeup_fd_);
+    }
+}
+
+bool UringEventLoop::is_supported() {
+    IoUring probe;
+    return probe.init(4);
+}
+
+bool UringEventLoop::setup() {
+    if (!ring_.init(PerformanceConfig::URING_QUEUE_DEPTH)) {
+        return false;
+    }
+
+    // 读eventfd是普通读操作，文件必须是阻塞的，io_uring才会等待而不是返回EAGAIN
+    wakeup_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (wakeup_fd_ == -1) {
+        std::cerr << "创建eventfd失败" << std::endl;
+        return false;
+    }
+
+    buffer_pool_.resize(PerformanceConfig::URING_BUFFER_COUNT * PerformanceConfig::URING_BUFFER_SIZE);
+    provide_buffers(0, static_cast<unsigned>(PerformanceConfig::URING_BUFFER_COUNT));
+    arm_accept();
+    arm_wakeup();
+    arm_timeout();
+    return true;
+}
+
+void UringEventLoop::run() {
+    std::cout << "事件循环 " << id_ << " 启动 (io_uring)..." << std::endl;
+
+    while (running_) {
+        // 一次系统调用同时提交本轮产生的所有SQE并等待新的完成事件
+        int ret = ring_.submit(1);
+        if (ret < 0 && errno != EINTR && errno != EBUSY && errno != EAGAIN) {
+            std::cerr << "io_uring_enter失败，错误码: " << errno << std::endl;
+            break;
+        }
+
+        ring_.for_each_cqe([this](const struct io_uring_cqe* cqe) {
+            handle_completion(cqe);
+        });
+    }
+
+    std::cout << "事件循环 " << id_ << " 退出" << std::endl;
+}
+
+void UringEventLoop::wakeup() {
+    uint64_t one = 1;
+    if (write(wakeup_fd_, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        std::cerr << "唤醒事件循环失败，错误码: " << errno << std::endl;
+    }
+}
+
+struct io_uring_sqe* UringEventLoop::next_sqe() {
+    struct io_uring_sqe* sqe = ring_.get_sqe();
+    while (!sqe) {
+        // 提交队列已满，先把已准备的SQE交给内核
+        ring_.submit();
+        sqe = ring_.get_sqe();
+    }
+    return sqe;
+}
+
+void UringEventLoop::handle_completion(const struct io_uring_cqe* cqe) {
+    uint64_t op = cqe->user_data & OP_MASK;
+    ConnectionSlot* slot = reinterpret_cast<ConnectionSlot*>(cqe->user_data & ~OP_MASK);
+
+    switch (op) {
+    case OP_ACCEPT:
+        handle_accept(cqe->res, cqe->flags);
+        break;
+    case OP_WAKEUP:
+        run_pending_functors();
+        if (running_) arm_wakeup();
+        break;
+    case OP_TIMEOUT:
+        cleanup_expired_connections();
+        resume_deferred_writes();
+        if (running_) arm_timeout();
+        break;
+    case OP_PROVIDE:
+        if (cqe->res < 0) {
+            std::cerr << "提供接收缓冲区失败，错误码: " << -cqe->res << std::endl;
+        }
+        break;
+    case OP_RECV:
+        slot->inflight--;
+        slot->recv_armed = false;
+        handle_recv(slot, cqe->res, cqe->flags);
+        after_io(slot);
+        break;
+    case OP_SEND:
+        slot->inflight--;
+        slot->send_armed = false;
+        if (slot->send_polling) {
+            // socket可写：文件节点由连接同步sendfile到内核发送缓冲区写满为止
+            slot->send_polling = false;
+            if (cqe->res < 0) {
+                slot->conn->async_close();
+            } else {
+                slot->conn->continue_write();
+                if (slot->conn->is_send_throttled()) {
+                    defer_write(slot->conn);
+                }
+            }
+        } else if (cqe->res > 0) {
+            slot->conn->on_data_sent(static_cast<size_t>(cqe->res));
+        } else if (cqe->res < 0) {
+            slot->conn->async_close();
+        }
+        after_io(slot);
+        break;
+    case OP_CLOSE:
+        slot->inflight--;
+        slot->close_submitted = false;
+        // 发送不完整时链接被打断，close以ECANCELED结束，socket仍然有效
+        if (cqe->res != -ECANCELED) {
+            slot->fd_closed = true;
+            slot->conn->close();
+        }
+        after_io(slot);
+        break;
+    case OP_CANCEL:
+    default:
+        break;
+    }
+}
+
+void UringEventLoop::handle_accept(int res, unsigned flags) {
+    if (res >= 0) {
+        auto connection = create_connection(res);
+        if (connection) {
+            auto slot = std::make_unique<ConnectionSlot>();
+            slot->conn = connection;
+            slot->fd = res;
+            slot->inflight = 0;
+            slot->recv_armed = false;
+            slot->send_armed = false;
+            slot->send_polling = false;
+            slot->close_submitted = false;
+            slot->fd_closed = false;
+            slot->closing = false;
+
+            ConnectionSlot* raw = slot.get();
+            slots_[connection.get()] = std::move(slot);
+            arm_recv(raw);
+        }
+    } else if (res != -ECANCELED) {
+        std::cerr << "接受连接失败，错误码: " << -res << std::endl;
+    }
+
+    // multishot accept在没有IORING_CQE_F_MORE时已终止，需要重新提交
+    if (!(flags & IORING_CQE_F_MORE) && running_) {
+        arm_accept();
+    }
+}
+
+void UringEventLoop::handle_recv(ConnectionSlot* slot, int res, unsigned flags) {
+    if (res > 0 && (flags & IORING_CQE_F_BUFFER)) {
+        unsigned short bid = static_cast<unsigned short>(flags >> IORING_CQE_BUFFER_SHIFT);
+        const char* data = buffer_pool_.data() + bid * PerformanceConfig::URING_BUFFER_SIZE;
+
+        slot->conn->on_data_received(data, static_cast<size_t>(res));
+
+        // 数据已复制进连接缓冲区，立即把缓冲区还给内核
+        provide_buffers(bid, 1);
+    } else if (res == -ENOBUFS) {
+        // 缓冲区暂时耗尽，等待归还后重新接收
+    } else {
+        // 对端关闭或出错
+        slot->conn->async_close();
+    }
+}
+
+void UringEventLoop::after_io(ConnectionSlot* slot) {
+    std::shared_ptr<Connection> conn = slot->conn;
+    ConnectionState state = conn->get_state();
+
+    if (slot->fd_closed || slot->closing ||
+        state == ConnectionState::CLOSING || state == ConnectionState::CLOSED) {
+        if (!slot->closing) {
+            slot->closing = true;
+            if (!slot->close_submitted) {
+                cancel(slot, OP_RECV);
+                cancel(slot, OP_SEND);
+            }
+        }
+
+        if (slot->inflight > 0) {
+            return;  // 等待在途操作全部完成后再释放
+        }
+
+        if (!slot->fd_closed) {
+            if (conn->get_socket() == INVALID_SOCKET) {
+                ::close(slot->fd);
+            }
+            conn->close();
+        }
+
+        slots_.erase(conn.get());
+        active_connections_--;
+        return;
+    }
+
+    if (state == ConnectionState::WRITING) {
+        // 发送不完整（链接被打断）时继续发送剩余数据；受限的连接由tick重试
+        if (!slot->send_armed && !conn->is_send_throttled()) {
+            submit_send(slot);
+        }
+    } else if (state == ConnectionState::CONNECTING || state == ConnectionState::READING) {
+        // 磁盘写入跟不上时不再提交接收，写入完成后由resume_read恢复
+        if (!slot->recv_armed && !conn->is_read_paused()) {
+            arm_recv(slot);
+        }
+    }
+}
+
+void UringEventLoop::send_response(const std::shared_ptr<Connection>& conn, ResponseBuffer response_data) {
+    auto it = slots_.find(conn.get());
+    if (it == slots_.end()) return;
+
+    conn->begin_write(std::move(response_data));
+    ConnectionSlot* slot = it->second.get();
+    if (!slot->send_armed) {
+        submit_send(slot);
+    }
+}
+
+void UringEventLoop::resume_write(const std::shared_ptr<Connection>& conn) {
+    auto it = slots_.find(conn.get());
+    if (it == slots_.end()) return;
+
+    ConnectionSlot* slot = it->second.get();
+    if (!slot->send_armed && !slot->closing) {
+        submit_send(slot);
+    }
+}
+
+void UringEventLoop::resume_read(const std::shared_ptr<Connection>& conn) {
+    auto it = slots_.find(conn.get());
+    if (it == slots_.end()) return;
+
+    after_io(it->second.get());
+}
+
+void UringEventLoop::arm_accept() {
+    struct io_uring_sqe* sqe = next_sqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_socket_;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = OP_ACCEPT;
+}
+
+void UringEventLoop::arm_wakeup() {
+    struct io_uring_sqe* sqe = next_sqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wakeup_fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(&wakeup_value_);
+    sqe->len = sizeof(wakeup_value_);
+    sqe->user_data = OP_WAKEUP;
+}
+
+void UringEventLoop::arm_timeout() {
+    struct io_uring_sqe* sqe = next_sqe();
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->addr = reinterpret_cast<uint64_t>(&tick_);
+    sqe->len = 1;
+    sqe->user_data = OP_TIMEOUT;
+}
+
+void UringEventLoop::arm_recv(ConnectionSlot* slot) {
+    struct io_uring_sqe* sqe = next_sqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = slot->fd;
+    sqe->len = static_cast<unsigned>(PerformanceConfig::URING_BUFFER_SIZE);
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP_ID;
+    sqe->user_data = reinterpret_cast<uint64_t>(slot) | OP_RECV;
+
+    slot->inflight++;
+    slot->recv_armed = true;
+}
+
+void UringEventLoop::submit_send(ConnectionSlot* slot) {
+    // 队首是文件时没有对应的异步sendfile，改为等待socket可写，再由连接同步sendfile
+    uint64_t file_offset = 0;
+    uint64_t file_length = 0;
+    if (slot->conn->front_write_file(file_offset, file_length)) {
+        struct io_uring_sqe* sqe = next_sqe();
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = slot->fd;
+        sqe->poll32_events = POLLOUT;
+        sqe->user_data = reinterpret_cast<uint64_t>(slot) | OP_SEND;
+        slot->inflight++;
+        slot->send_armed = true;
+        slot->send_polling = true;
+        return;
+    }
+
+    size_t pending = static_cast<size_t>(slot->conn->pending_write_bytes());
+
+    // 限速：令牌不足时暂不提交，等下一个tick重试
+    size_t quota = slot->conn->acquire_send_quota(pending);
+    if (quota == 0) {
+        defer_write(slot->conn);
+        return;
+    }
+
+    // 输出缓冲区的各个节点作为iovec交给sendmsg，不拼接
+    slot->send_msg = {};
+    slot->send_msg.msg_iov = slot->send_iov;
+    slot->send_msg.msg_iovlen = slot->conn->fill_write_buffers(slot->send_iov, quota);
+
+    // iovec数量有限或遇到文件节点时本次发送少于配额，多余的令牌归还
+    size_t filled = 0;
+    for (size_t i = 0; i < slot->send_msg.msg_iovlen; ++i) {
+        filled += slot->send_iov[i].iov_len;
+    }
+    if (filled < quota) {
+        slot->conn->refund_send_quota(quota - filled);
+    }
+
+    struct io_uring_sqe* sqe = next_sqe();
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = slot->fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&slot->send_msg);
+    sqe->len = 1;
+    // MSG_WAITALL：短写会打断链接，避免close在数据未发完时执行
+    sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+    sqe->user_data = reinterpret_cast<uint64_t>(slot) | OP_SEND;
+    slot->inflight++;
+    slot->send_armed = true;
+
+    // 只有本次发送覆盖全部剩余数据时才链接close
+    if (slot->conn->close_after_write() && filled == pending) {
+        sqe->flags |= IOSQE_IO_LINK;
+
+        struct io_uring_sqe* close_sqe = next_sqe();
+        close_sqe->opcode = IORING_OP_CLOSE;
+        close_sqe->fd = slot->fd;
+        close_sqe->user_data = reinterpret_cast<uint64_t>(slot) | OP_CLOSE;
+        slot->inflight++;
+        slot->close_submitted = true;
+
+        // socket将由链接的close关闭
+        slot->conn->release_socket();
+    }
+}
+
+void UringEventLoop::provide_buffers(unsigned short bid, unsigned count) {
+    struct io_uring_sqe* sqe = next_sqe();
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = static_cast<int>(count);
+    sqe->addr = reinterpret_cast<uint64_t>(buffer_pool_.data() + bid * PerformanceConfig::URING_BUFFER_SIZE);
+    sqe->len = static_cast<unsigned>(PerformanceConfig::URING_BUFFER_SIZE);
+    sqe->off = bid;
+    sqe->buf_group = BUFFER_GROUP_ID;
+    sqe->user_data = OP_PROVIDE;
+}
+
+void UringEventLoop::cancel(ConnectionSlot* slot, unsigned op) {
+    if ((op == OP_RECV && !slot->recv_armed) || (op == OP_SEND && !slot->send_armed)) {
+        return;
+    }
+
+    struct io_uring_sqe* sqe = next_sqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = reinterpret_cast<uint64_t>(slot) | op;
+    sqe->user_data = OP_CANCEL;
+}
+
+void UringEventLoop::cleanup_expired_connections() {
+    timer_wheel_.advance(std::chrono::steady_clock::now(), [this](const std::shared_ptr<Connection>& conn) {
+        auto it = slots_.find(conn.get());
+        if (it == slots_.end() || it->second->closing) return;
+
+        std::cout << "清理过期连接: " << conn->get_client_ip() << std::endl;
+        conn->async_close();
+        after_io(it->second.get());
+    });
+}
+
+void UringEventLoop::close_all_connections() {
+    for (auto& entry : slots_) {
+        ConnectionSlot* slot = entry.second.get();
+        if (!slot->fd_closed) {
+            if (slot->conn->get_socket() == INVALID_SOCKET) {
+                ::close(slot->fd);
+            }
+            slot->conn->close();
+            slot->fd_closed = true;
+        }
+    }
+    active_connections_ -= slots_.size();
+    timer_wheel_.clear();
+}
+
+#endif // HAVE_IO_URING
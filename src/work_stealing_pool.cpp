@@ -0,0 +1,145 @@
+#include "../include/work_stealing_pool.h"
+#include <iostream>
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(const std::string& name, size_t thread_count, size_t queue_capacity)
+    : name_(name), next_queue_(0), sleepers_(0), stopping_(false),
+      active_tasks_(0), submitted_tasks_(0), rejected_tasks_(0), completed_tasks_(0),
+      stolen_tasks_(0), total_wait_us_(0) {
+    thread_count = (std::max)(thread_count, size_t(1));
+    size_t per_queue = (std::max)(queue_capacity / thread_count, size_t(2));
+
+    for (size_t i = 0; i < thread_count; ++i) {
+        queues_.push_back(std::make_unique<TaskQueue>(per_queue));
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    stop();
+}
+
+void WorkStealingPool::start(TaskHandler handler) {
+    handler_ = std::move(handler);
+    for (size_t i = 0; i < queues_.size(); ++i) {
+        threads_.emplace_back(&WorkStealingPool::worker_loop, this, i);
+    }
+}
+
+void WorkStealingPool::stop() {
+    if (stopping_.exchange(true)) return;
+
+    for (auto& queue : queues_) {
+        queue->shutdown();
+    }
+    // 计数足够大，当前和之后的等待都会立即返回
+    wakeup_.post(1u << 30);
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+bool WorkStealingPool::submit(AsyncTask task) {
+    if (stopping_.load(std::memory_order_relaxed)) {
+        rejected_tasks_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // 轮转选择起始队列，满了再尝试其他队列
+    size_t count = queues_.size();
+    size_t start = next_queue_.fetch_add(1, std::memory_order_relaxed);
+    bool queued = false;
+    for (size_t i = 0; i < count && !queued; ++i) {
+        queued = queues_[(start + i) % count]->push(std::move(task));
+    }
+    if (!queued) {
+        rejected_tasks_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    submitted_tasks_.fetch_add(1, std::memory_order_relaxed);
+
+    // 与工作线程登记睡眠配对的全屏障，保证不会丢失唤醒
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) > 0) {
+        wakeup_.post();
+    }
+    return true;
+}
+
+bool WorkStealingPool::next_task(size_t index, AsyncTask& task) {
+    if (queues_[index]->try_pop(task)) {
+        return true;
+    }
+
+    // 自己的队列为空，从相邻线程开始依次窃取
+    size_t count = queues_.size();
+    for (size_t i = 1; i < count; ++i) {
+        if (queues_[(index + i) % count]->try_pop(task)) {
+            stolen_tasks_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::worker_loop(size_t index) {
+    AsyncTask task;
+    while (!stopping_.load(std::memory_order_acquire)) {
+        if (!next_task(index, task)) {
+            // 先登记为睡眠者再检查一次，与submit中的屏障配对
+            sleepers_.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool found = next_task(index, task);
+            if (!found && !stopping_.load(std::memory_order_acquire)) {
+                wakeup_.wait();
+            }
+            sleepers_.fetch_sub(1);
+            if (!found) continue;
+        }
+
+        auto waited = std::chrono::steady_clock::now() - task.timestamp;
+        total_wait_us_.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(waited).count(),
+                                 std::memory_order_relaxed);
+        active_tasks_.fetch_add(1, std::memory_order_relaxed);
+
+        try {
+            handler_(task);
+        } catch (const std::exception& e) {
+            std::cerr << name_ << " 工作线程 " << index << " 处理任务时发生异常: " << e.what() << std::endl;
+        }
+        task = AsyncTask();  // 及时释放任务持有的连接
+
+        active_tasks_.fetch_sub(1, std::memory_order_relaxed);
+        completed_tasks_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+WorkStealingPool::Metrics WorkStealingPool::get_metrics() const {
+    Metrics metrics;
+    metrics.name = name_;
+    metrics.threads = queues_.size();
+    metrics.queue_capacity = 0;
+    for (const auto& queue : queues_) {
+        metrics.queue_capacity += queue->capacity();
+    }
+    metrics.pending = pending_tasks();
+    metrics.active = active_tasks_.load(std::memory_order_relaxed);
+    metrics.submitted = submitted_tasks_.load(std::memory_order_relaxed);
+    metrics.rejected = rejected_tasks_.load(std::memory_order_relaxed);
+    metrics.completed = completed_tasks_.load(std::memory_order_relaxed);
+    metrics.stolen = stolen_tasks_.load(std::memory_order_relaxed);
+    metrics.avg_wait_ms = metrics.completed > 0
+        ? total_wait_us_.load(std::memory_order_relaxed) / 1000.0 / metrics.completed
+        : 0.0;
+    return metrics;
+}
+
+size_t WorkStealingPool::pending_tasks() const {
+    size_t total = 0;
+    for (const auto& queue : queues_) {
+        total += queue->size();
+    }
+    return total;
+}